@@ -0,0 +1,112 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <iostream>
+#include <set>
+#include <array>
+#include <distmesh/distmesh.h>
+#include "helper.h"
+
+// reference implementation of edge extraction based on std::set
+Eigen::ArrayXXi findUniqueEdgesReference(Eigen::Ref<Eigen::ArrayXXi const> const triangulation) {
+    auto const combinations = distmesh::utils::nOverK(triangulation.cols(), 2);
+
+    std::set<std::array<int, 2>> uniqueEdges;
+    std::array<int, 2> edge = {{0, 0}};
+    for (int combination = 0; combination < combinations.rows(); ++combination)
+    for (int triangle = 0; triangle < triangulation.rows(); ++triangle) {
+        edge[0] = triangulation(triangle, combinations(combination, 0));
+        edge[1] = triangulation(triangle, combinations(combination, 1));
+
+        edge = edge[1] < edge[0] ? std::array<int, 2>{{edge[1], edge[0]}} : edge;
+
+        uniqueEdges.insert(edge);
+    }
+
+    Eigen::ArrayXXi edgeIndices(uniqueEdges.size(), 2);
+    int index = 0;
+    for (auto const& edge : uniqueEdges) {
+        edgeIndices(index, 0) = edge[0];
+        edgeIndices(index, 1) = edge[1];
+
+        index++;
+    }
+
+    return edgeIndices;
+}
+
+int main() {
+    // create a structured triangulation of a square with about 2M elements
+    int const pointsPerDimension = 1000;
+    Eigen::ArrayXXi triangulation(2 * (pointsPerDimension - 1) * (pointsPerDimension - 1), 3);
+    int element = 0;
+    for (int i = 0; i < pointsPerDimension - 1; ++i)
+    for (int j = 0; j < pointsPerDimension - 1; ++j) {
+        int const node = i * pointsPerDimension + j;
+        triangulation.row(element++) << node, node + 1, node + pointsPerDimension;
+        triangulation.row(element++) << node + 1, node + pointsPerDimension + 1, node + pointsPerDimension;
+    }
+
+    // time reference implementation
+    distmesh::helper::HighPrecisionTime time;
+    auto const referenceEdges = findUniqueEdgesReference(triangulation);
+    double const referenceTime = time.elapsed();
+
+    // time library implementation
+    time.restart();
+    auto const edges = distmesh::utils::findUniqueEdges(triangulation);
+    double const libraryTime = time.elapsed();
+
+    // print timings and speedup
+    std::cout << "Extracted " << edges.rows() << " edges from " << triangulation.rows() <<
+        " elements." << std::endl;
+    std::cout << "std::set: " << referenceTime * 1e3 << " ms, packed keys: " <<
+        libraryTime * 1e3 << " ms, speedup: " << referenceTime / libraryTime << std::endl;
+
+    // check both implementations for identical results
+    if ((referenceEdges.rows() != edges.rows()) || (referenceEdges != edges).any()) {
+        std::cout << "Error: edge lists differ!" << std::endl;
+        return 1;
+    }
+
+    // time creation of element to edge table
+    time.restart();
+    auto const edgeIndices = distmesh::utils::getTriangulationEdgeIndices(triangulation, edges);
+    std::cout << "Element to edge table: " << time.elapsed() * 1e3 << " ms" << std::endl;
+
+    if ((edgeIndices < 0).any()) {
+        std::cout << "Error: element edge missing in edge list!" << std::endl;
+        return 1;
+    }
+
+    // time orientation fix of boundary edges
+    Eigen::ArrayXXd nodes(pointsPerDimension * pointsPerDimension, 2);
+    for (int node = 0; node < nodes.rows(); ++node) {
+        nodes.row(node) << node % pointsPerDimension, node / pointsPerDimension;
+    }
+
+    time.restart();
+    auto const orientedEdges = distmesh::utils::fixBoundaryEdgeOrientation(nodes,
+        triangulation, edges, edgeIndices);
+    std::cout << "Boundary edge orientation: " << time.elapsed() * 1e3 << " ms, " <<
+        (orientedEdges != edges).rowwise().any().count() << " edges reversed" << std::endl;
+
+    return 0;
+}
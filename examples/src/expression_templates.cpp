@@ -0,0 +1,68 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <iostream>
+#include <distmesh/distmesh.h>
+#include "helper.h"
+
+int main() {
+    // random points in unit square
+    Eigen::ArrayXXd points = 0.5 * (Eigen::ArrayXXd::Random(1000000, 2) + 1.0);
+
+    // element size function similar to the one of square example,
+    // once as Functional and once as compile time expression
+    Eigen::ArrayXd midpoint(2);
+    midpoint << 0.5, 0.6;
+    distmesh::Functional const sizeFunction =
+        (0.01 + 0.3 * distmesh::distanceFunction::circular(0.0).abs())
+        .min(0.025 + 0.3 * distmesh::distanceFunction::circular(0.2, midpoint).abs())
+        .min(0.15);
+    auto const sizeExpression =
+        (0.01 + 0.3 * distmesh::expression::circular(0.0).abs())
+        .min(0.025 + 0.3 * distmesh::expression::circular(0.2, midpoint).abs())
+        .min(0.15);
+
+    // time both evaluations
+    distmesh::helper::HighPrecisionTime time;
+    Eigen::ArrayXd const functionalResult = sizeFunction(points);
+    double const functionalTime = time.elapsed();
+
+    time.restart();
+    Eigen::ArrayXd const expressionResult = sizeExpression(points);
+    double const expressionTime = time.elapsed();
+
+    std::cout << "Evaluated size function at " << points.rows() << " points." << std::endl;
+    std::cout << "Functional: " << functionalTime * 1e3 << " ms, expression template: " <<
+        expressionTime * 1e3 << " ms, speedup: " << functionalTime / expressionTime << std::endl;
+
+    if (!functionalResult.isApprox(expressionResult)) {
+        std::cout << "Error: results differ!" << std::endl;
+        return 1;
+    }
+
+    // expressions can be mixed with Functional and passed to distmesh algorithm
+    distmesh::Functional const distanceFunction = distmesh::expression::circular(1.0)
+        .max(-distmesh::distanceFunction::circular(0.5));
+    auto const mesh = distmesh::distmesh(distanceFunction, 0.1,
+        0.1 + 0.3 * distmesh::expression::circular(0.5));
+    std::cout << "Created mesh with " << std::get<0>(mesh).rows() << " points." << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <iostream>
+#include <distmesh/distmesh.h>
+#include "helper.h"
+
+int main() {
+    // both kernels relax the same initial points, which are created once with a fixed seed
+    distmesh::Functional const distanceFunction = distmesh::distanceFunction::circular(1.0);
+    distmesh::Options initialization;
+    initialization.seed = 42;
+    Eigen::ArrayXXd const initialPoints = distmesh::utils::createInitialPoints(distanceFunction,
+        0.02, 1.0, distmesh::utils::boundingBox(2), Eigen::ArrayXXd(0, 2), initialization);
+
+    // compare both force assembly kernels on the same problem
+    Eigen::ArrayXXd points[2];
+    Eigen::ArrayXXi elements[2];
+    distmesh::ForceAssembly const kernels[2] = {
+        distmesh::ForceAssembly::scatter, distmesh::ForceAssembly::gather };
+    char const* const names[2] = { "scatter", "gather" };
+
+    for (int kernel = 0; kernel < 2; ++kernel) {
+        distmesh::Options options;
+        options.forceAssembly = kernels[kernel];
+
+        distmesh::helper::HighPrecisionTime time;
+        std::tie(points[kernel], elements[kernel]) = distmesh::relax(
+            distanceFunction, 0.02, 1.0, initialPoints, 0, options);
+
+        std::cout << names[kernel] << ": " << points[kernel].rows() << " points, " <<
+            elements[kernel].rows() << " elements in " << time.elapsed() * 1e3 << " ms" << std::endl;
+    }
+
+    // both kernels differ only in the summation order of the edge forces
+    if (points[0].rows() == points[1].rows()) {
+        std::cout << "Maximum point deviation: " <<
+            (points[0] - points[1]).abs().maxCoeff() << std::endl;
+    }
+
+    return 0;
+}
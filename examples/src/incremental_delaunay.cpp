@@ -0,0 +1,98 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <distmesh/distmesh.h>
+#include <distmesh/triangulation.h>
+#include "helper.h"
+
+// triangles with sorted vertices in lexicographical order, to compare
+// triangulations independent of their orientation and ordering
+std::vector<std::array<int, 3>> sortedTriangles(Eigen::Ref<Eigen::ArrayXXi const> const triangulation) {
+    std::vector<std::array<int, 3>> triangles(triangulation.rows());
+    for (int triangle = 0; triangle < triangulation.rows(); ++triangle) {
+        triangles[triangle] = {{ triangulation(triangle, 0), triangulation(triangle, 1),
+            triangulation(triangle, 2) }};
+        std::sort(triangles[triangle].begin(), triangles[triangle].end());
+    }
+    std::sort(triangles.begin(), triangles.end());
+
+    return triangles;
+}
+
+int main() {
+    // random points in the unit square with a fixed seed, some of them almost on its
+    // edges, which results in very flat triangles along the convex hull
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    int const pointCount = 20000;
+    int const boundaryPointCount = 2000;
+    Eigen::ArrayXXd points(pointCount, 2);
+    for (int point = 0; point < pointCount; ++point) {
+        points(point, 0) = 0.01 + 0.98 * uniform(generator);
+        points(point, 1) = 0.01 + 0.98 * uniform(generator);
+    }
+    for (int point = 0; point < boundaryPointCount; ++point) {
+        double const offset = 1e-6 * uniform(generator);
+        points(point, point % 2) = point % 4 < 2 ? offset : 1.0 - offset;
+    }
+
+    // create initial triangulation
+    distmesh::triangulation::IncrementalDelaunay incremental;
+    incremental.rebuild(points);
+
+    // move inner points a bit like a distmesh step, without leaving the square,
+    // and compare the repaired triangulation of the kernel with the one of qhull
+    double repairTime = 0.0, qhullTime = 0.0;
+    for (int step = 0; step < 10; ++step) {
+        for (int point = boundaryPointCount; point < pointCount; ++point) {
+            points(point, 0) += 1e-3 * (uniform(generator) - 0.5);
+            points(point, 1) += 1e-3 * (uniform(generator) - 0.5);
+        }
+
+        distmesh::helper::HighPrecisionTime time;
+        if (!incremental.repair(points)) {
+            incremental.rebuild(points);
+        }
+        auto const triangulation = incremental.triangles();
+        repairTime += time.elapsed();
+
+        time.restart();
+        auto const reference = distmesh::triangulation::qhull(points);
+        qhullTime += time.elapsed();
+
+        if (sortedTriangles(triangulation) != sortedTriangles(reference)) {
+            std::cout << "Error: triangulations differ in step " << step << "!" << std::endl;
+            return 1;
+        }
+    }
+
+    // print timings and speedup
+    std::cout << "Triangulated " << pointCount << " moving points." << std::endl;
+    std::cout << "qhull: " << qhullTime * 1e3 << " ms, incremental repair: " <<
+        repairTime * 1e3 << " ms, speedup: " << qhullTime / repairTime << std::endl;
+
+    return 0;
+}
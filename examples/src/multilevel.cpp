@@ -0,0 +1,74 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <iostream>
+#include <distmesh/distmesh.h>
+#include "helper.h"
+
+// minimum ratio of twice the inradius to the circumradius of all triangles
+double minimumQuality(Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXXi const> const elements) {
+    double quality = 1.0;
+    for (int element = 0; element < elements.rows(); ++element) {
+        double const a = std::sqrt((points.row(elements(element, 1)) -
+            points.row(elements(element, 2))).square().sum());
+        double const b = std::sqrt((points.row(elements(element, 0)) -
+            points.row(elements(element, 2))).square().sum());
+        double const c = std::sqrt((points.row(elements(element, 0)) -
+            points.row(elements(element, 1))).square().sum());
+
+        quality = std::min(quality, (b + c - a) * (c + a - b) * (a + b - c) / (a * b * c));
+    }
+
+    return quality;
+}
+
+int main() {
+    // compare single level and multilevel meshing of the same fine problem
+    Eigen::ArrayXXd points;
+    Eigen::ArrayXXi elements;
+
+    distmesh::helper::HighPrecisionTime time;
+    std::tie(points, elements) = distmesh::distmesh(
+        distmesh::distanceFunction::circular(1.0), 0.01);
+
+    double elapsed = time.elapsed();
+    std::cout << "single level: " << points.rows() << " points, " << elements.rows() <<
+        " elements in " << elapsed * 1e3 << " ms, minimum quality " <<
+        minimumQuality(points, elements) << std::endl;
+
+    // mesh at 4 times the point distance and refine twice
+    time.restart();
+    std::tie(points, elements) = distmesh::multilevel(
+        distmesh::distanceFunction::circular(1.0), 0.01, 1.0,
+        distmesh::utils::boundingBox(2), Eigen::ArrayXXd(), distmesh::Options(), 3);
+
+    elapsed = time.elapsed();
+    std::cout << "multilevel: " << points.rows() << " points, " << elements.rows() <<
+        " elements in " << elapsed * 1e3 << " ms, minimum quality " <<
+        minimumQuality(points, elements) << std::endl;
+
+    // save mesh to file
+    distmesh::helper::savetxt<double>(points, "points.txt");
+    distmesh::helper::savetxt<int>(elements, "triangulation.txt");
+
+    // plot mesh using python
+    return system("python plot_mesh.py");
+}
@@ -0,0 +1,65 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <iostream>
+#include <distmesh/distmesh.h>
+#include "helper.h"
+
+int main() {
+    distmesh::helper::HighPrecisionTime time;
+
+    // finely resolved outline with two holes, given as separate rings
+    Eigen::ArrayXXd outline(20000, 2);
+    for (int i = 0; i < outline.rows(); ++i) {
+        double const angle = 2.0 * M_PI * i / outline.rows();
+        double const radius = 0.8 + 0.1 * std::sin(7.0 * angle) + 0.02 * std::sin(97.0 * angle);
+        outline.row(i) << radius * std::cos(angle), radius * std::sin(angle);
+    }
+
+    Eigen::ArrayXXd hole(4, 2);
+    hole << -0.4, -0.2, -0.1, -0.2, -0.1, 0.2, -0.4, 0.2;
+
+    Eigen::ArrayXXd triangle(3, 2);
+    triangle << 0.2, -0.1, 0.5, -0.1, 0.35, 0.2;
+
+    std::vector<Eigen::ArrayXXd> rings = { outline, hole, triangle };
+
+    // create mesh
+    Eigen::ArrayXXd fixedPoints(hole.rows() + triangle.rows(), 2);
+    fixedPoints << hole, triangle;
+
+    Eigen::ArrayXXd points;
+    Eigen::ArrayXXi elements;
+
+    std::tie(points, elements) = distmesh::distmesh(
+        distmesh::distanceFunction::polygon(rings),
+        0.04, 1.0, distmesh::utils::boundingBox(2), fixedPoints);
+
+    // print mesh properties and elapsed time
+    std::cout << "Created mesh with " << points.rows() << " points and " << elements.rows() <<
+        " elements in " << time.elapsed() * 1e3 << " ms." << std::endl;
+
+    // save mesh to file
+    distmesh::helper::savetxt<double>(points, "points.txt");
+    distmesh::helper::savetxt<int>(elements, "triangulation.txt");
+
+    // plot mesh using python
+    return system("python plot_mesh.py");
+}
@@ -0,0 +1,73 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#ifndef _d7492751_013c_4f03_8ce1_aabd18eb4be5
+#define _d7492751_013c_4f03_8ce1_aabd18eb4be5
+
+namespace distmesh {
+namespace geometry {
+    // binary tree in 1d, quadtree in 2d or octree in 3d caching a function by multilinear
+    // interpolation of its values at the corners of the leaf cells, cells are refined where
+    // the interpolation deviates from the function or its zero level set may cross them,
+    // so the memory scales with the complexity of the boundary and not with the volume,
+    // functions without slope bound are refined everywhere down to the minimum size,
+    // all queries are const and can be used concurrently
+    class AdaptiveTree {
+    public:
+        // sample function level by level, with all new sampling points of a level
+        // evaluated at once using the given evaluation policy
+        AdaptiveTree(Functional const& function, Eigen::Ref<Eigen::ArrayXXd const> const boundingBox,
+            double const minimumSize, double const tolerance,
+            EvaluationPolicy const& policy=EvaluationPolicy());
+
+        // interpolate function at points, points outside of the bounding
+        // box are extrapolated from the nearest leaf cell
+        void evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const;
+
+        // interpolate function and its gradient
+        void evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient) const;
+
+        // accessors
+        unsigned cellCount() const { return this->cells_.size(); }
+        unsigned dimension() const { return this->origin_.rows(); }
+
+    private:
+        // cell of the tree, the children of a cell are stored consecutively
+        // with the bits of their index selecting the upper half in each dimension,
+        // values of the corners are ordered the same way
+        struct Cell {
+            int firstChild;
+            int values;
+        };
+
+        void interpolate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd>* const gradient) const;
+
+        Eigen::ArrayXd origin_;
+        Eigen::ArrayXd extent_;
+        std::vector<Cell> cells_;
+        std::vector<double> values_;
+    };
+}
+}
+
+#endif
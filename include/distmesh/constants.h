@@ -23,6 +23,8 @@
 
 namespace distmesh {
 namespace constants {
+    // all settings but geometryEvaluationThreshold are defaults of distmesh::Options
+
     // algorithm stops, when maximum relative points movement is below threshold
     static double const pointsMovementThreshold = 1e-3;
 
@@ -38,9 +40,19 @@ namespace constants {
     // step size for numerical differentiation
     static double const deltaX = std::sqrt(std::numeric_limits<double>::epsilon());
 
+    // number of points evaluated at once by the compiled program of a Functional
+    // with EvaluationPolicy::blocked(), such that all intermediate values fit into the cache
+    static unsigned const evaluationBlockSize = 4096;
+
     // algorithm will be terminated after the maximum number of iterations,
     // when no convergence can be achieved
     static unsigned const maxSteps = 10000;
+
+    // relative width of the band of points checked for projection, zero checks all points
+    static double const boundaryBandWidth = 0.0;
+
+    // seed of the random selection of initial points
+    static uint64_t const seed = 0;
 }
 }
 
@@ -45,6 +45,28 @@ namespace distanceFunction {
     // Attention: Not a real distance function at the corners of domainm
     // you have to give the corners as fixed points to distmesh algorithm
     Functional polygon(Eigen::Ref<Eigen::ArrayXXd const> const polygon);
+
+    // creates distance function for a 2d domain described by multiple closed rings,
+    // holes are given as rings inside of other rings, distances use a bounding volume
+    // hierarchy and inside tests a grid over all segments to support large polygons
+    Functional polygon(std::vector<Eigen::ArrayXXd> const& rings);
+
+    // samples a 1d, 2d or 3d function once at the nodes of a regular grid covering the
+    // bounding box with given spacing, and creates a function interpolating these values
+    // multilinearly with analytic gradient, whose cost is independent of the complexity
+    // of the sampled function, sampling uses the given evaluation policy
+    Functional sampled(Functional const& function,
+        Eigen::Ref<Eigen::ArrayXXd const> const boundingBox, double const resolution,
+        EvaluationPolicy const& policy=EvaluationPolicy());
+
+    // caches a 1d, 2d or 3d function in an adaptive tree covering the bounding box, cells
+    // are refined down to the minimum size, where multilinear interpolation deviates more
+    // than tolerance from the function, or where its zero level set may cross them,
+    // which is assumed everywhere for functions without slope bound, e.g. lambdas,
+    // so it can be used for distance and element size functions alike
+    Functional adaptive(Functional const& function,
+        Eigen::Ref<Eigen::ArrayXXd const> const boundingBox, double const minimumSize,
+        double const tolerance, EvaluationPolicy const& policy=EvaluationPolicy());
 }
 }
 
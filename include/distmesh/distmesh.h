@@ -22,16 +22,30 @@
 #define _c7492357_ec3f_4dbf_b941_9175e9f79ab0
 
 // standard c++ lib
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <tuple>
+#include <vector>
 
 // Eigen lib for array handling
 #include <Eigen/Core>
 
 // libdistmesh includes
+#include "expression_graph.h"
 #include "functional.h"
+#include "expression.h"
+#include "segment_tree.h"
+#include "adaptive_tree.h"
 #include "distance_function.h"
+#include "options.h"
+#include "workspace.h"
 #include "utils.h"
+#include "inside_grid.h"
 
 namespace distmesh {
     // apply the distmesh algorithm
@@ -39,7 +53,25 @@ namespace distmesh {
         Functional const& distanceFunction, double const initialPointDistance,
         Functional const& elementSizeFunction=1.0,
         Eigen::Ref<Eigen::ArrayXXd const> const boundingBox=utils::boundingBox(2),
-        Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints=Eigen::ArrayXXd());
+        Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints=Eigen::ArrayXXd(),
+        Options const& options=Options());
+
+    // apply the distmesh algorithm starting from given points,
+    // whose first fixedPointCount rows are fixed
+    std::tuple<Eigen::ArrayXXd, Eigen::ArrayXXi> relax(
+        Functional const& distanceFunction, double const initialPointDistance,
+        Functional const& elementSizeFunction, Eigen::Ref<Eigen::ArrayXXd const> const initialPoints,
+        int const fixedPointCount=0, Options const& options=Options());
+
+    // apply the distmesh algorithm to a mesh with 2^(levels - 1) times the initial point
+    // distance and refine it by edge midpoint insertion for each further level, which
+    // is relaxed for at most levelSteps steps
+    std::tuple<Eigen::ArrayXXd, Eigen::ArrayXXi> multilevel(
+        Functional const& distanceFunction, double const initialPointDistance,
+        Functional const& elementSizeFunction=1.0,
+        Eigen::Ref<Eigen::ArrayXXd const> const boundingBox=utils::boundingBox(2),
+        Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints=Eigen::ArrayXXd(),
+        Options const& options=Options(), unsigned const levels=3, unsigned const levelSteps=50);
 }
 
 #endif
@@ -0,0 +1,439 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#ifndef _5a0e7c92_d316_4b8f_a4c7_19e8b2f06d3a
+#define _5a0e7c92_d316_4b8f_a4c7_19e8b2f06d3a
+
+namespace distmesh {
+namespace expression {
+    // compile time alternative to Functional, which fuses a whole expression tree
+    // into a single pass over blocks of points without indirect calls, each expression
+    // evaluates a block of points by Eigen array operations into the given result,
+    // so only block sized temporaries are needed, which stay in cache
+    static int const blockSize = 256;
+    typedef Eigen::Array<double, Eigen::Dynamic, 1, Eigen::ColMajor, blockSize, 1> BlockArray;
+
+    // transformed points of a block are stored on the stack up to this dimension,
+    // only higher dimensional points need a heap allocated temporary
+    static int const maxBlockDimension = 3;
+    typedef Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor,
+        blockSize, maxBlockDimension> BlockPoints;
+
+    // coefficient wise operations applied by the unary and binary expressions
+    struct Negate {
+        template <class X> static auto apply(X const& x) -> decltype(-x) { return -x; }
+    };
+    struct Absolute {
+        template <class X> static auto apply(X const& x) -> decltype(x.abs()) { return x.abs(); }
+    };
+    struct Sum {
+        template <class X, class Y> static auto apply(X const& x, Y const& y) -> decltype(x + y) {
+            return x + y;
+        }
+    };
+    struct Difference {
+        template <class X, class Y> static auto apply(X const& x, Y const& y) -> decltype(x - y) {
+            return x - y;
+        }
+    };
+    struct Product {
+        template <class X, class Y> static auto apply(X const& x, Y const& y) -> decltype(x * y) {
+            return x * y;
+        }
+    };
+    struct Quotient {
+        template <class X, class Y> static auto apply(X const& x, Y const& y) -> decltype(x / y) {
+            return x / y;
+        }
+    };
+    struct Minimum {
+        template <class X, class Y> static auto apply(X const& x, Y const& y) -> decltype(x.min(y)) {
+            return x.min(y);
+        }
+    };
+    struct Maximum {
+        template <class X, class Y> static auto apply(X const& x, Y const& y) -> decltype(x.max(y)) {
+            return x.max(y);
+        }
+    };
+
+    class Constant;
+    template <class Operand, class Operation> class Unary;
+    template <class Lhs, class Rhs, class Operation> class Binary;
+    template <class Operand> class Shift;
+    template <class Operand> class Rotate2D;
+
+    // base class of all expressions
+    template <
+        class Derived
+    >
+    class Expression {
+    public:
+        Derived const& derived() const { return static_cast<Derived const&>(*this); }
+
+        // evaluate expression for all points block wise
+        void evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            for (int start = 0; start < points.rows(); start += blockSize) {
+                int const rows = std::min(blockSize, static_cast<int>(points.rows()) - start);
+                this->derived().evaluateBlock(points.middleRows(start, rows),
+                    result.segment(start, rows));
+            }
+        }
+        Eigen::ArrayXd operator() (Eigen::Ref<Eigen::ArrayXXd const> const points) const {
+            Eigen::ArrayXd result(points.rows());
+            this->evaluate(points, result);
+
+            return result;
+        }
+
+        // mathematical methods
+        template <
+            class Rhs
+        >
+        Binary<Derived, Rhs, Minimum> min(Expression<Rhs> const& rhs) const {
+            return Binary<Derived, Rhs, Minimum>(this->derived(), rhs.derived());
+        }
+        Binary<Derived, Constant, Minimum> min(double const rhs) const {
+            return Binary<Derived, Constant, Minimum>(this->derived(), Constant(rhs));
+        }
+        Functional min(Functional const& rhs) const {
+            return Functional(*this).min(rhs);
+        }
+        template <
+            class Rhs
+        >
+        Binary<Derived, Rhs, Maximum> max(Expression<Rhs> const& rhs) const {
+            return Binary<Derived, Rhs, Maximum>(this->derived(), rhs.derived());
+        }
+        Binary<Derived, Constant, Maximum> max(double const rhs) const {
+            return Binary<Derived, Constant, Maximum>(this->derived(), Constant(rhs));
+        }
+        Functional max(Functional const& rhs) const {
+            return Functional(*this).max(rhs);
+        }
+        Unary<Derived, Absolute> abs() const {
+            return Unary<Derived, Absolute>(this->derived());
+        }
+
+        // geometric transform
+        Shift<Derived> shift(Eigen::Ref<Eigen::ArrayXd const> const offset) const {
+            return Shift<Derived>(this->derived(), offset);
+        }
+        Rotate2D<Derived> rotate2D(double const angle) const {
+            return Rotate2D<Derived>(this->derived(), angle);
+        }
+    };
+
+    class Constant : public Expression<Constant> {
+    public:
+        Constant(double const constant) : constant_(constant) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            result.setConstant(this->constant_);
+        }
+        double constant() const { return this->constant_; }
+
+    private:
+        double constant_;
+    };
+
+    template <
+        class Operand,
+        class Operation
+    >
+    class Unary : public Expression<Unary<Operand, Operation>> {
+    public:
+        Unary(Operand const& operand) : operand_(operand) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            this->operand_.evaluateBlock(points, result);
+            result = Operation::apply(result);
+        }
+
+    private:
+        Operand operand_;
+    };
+
+    // the rhs is evaluated into a block sized temporary on the stack, constant
+    // operands are applied as scalars without any temporary
+    template <
+        class Lhs,
+        class Rhs,
+        class Operation
+    >
+    class Binary : public Expression<Binary<Lhs, Rhs, Operation>> {
+    public:
+        Binary(Lhs const& lhs, Rhs const& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            this->lhs_.evaluateBlock(points, result);
+            BlockArray rhs(points.rows());
+            this->rhs_.evaluateBlock(points, rhs);
+            result = Operation::apply(result, rhs);
+        }
+
+    private:
+        Lhs lhs_;
+        Rhs rhs_;
+    };
+
+    template <
+        class Lhs,
+        class Operation
+    >
+    class Binary<Lhs, Constant, Operation> : public Expression<Binary<Lhs, Constant, Operation>> {
+    public:
+        Binary(Lhs const& lhs, Constant const& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            this->lhs_.evaluateBlock(points, result);
+            result = Operation::apply(result,
+                BlockArray::Constant(points.rows(), this->rhs_.constant()));
+        }
+
+    private:
+        Lhs lhs_;
+        Constant rhs_;
+    };
+
+    template <
+        class Rhs,
+        class Operation
+    >
+    class Binary<Constant, Rhs, Operation> : public Expression<Binary<Constant, Rhs, Operation>> {
+    public:
+        Binary(Constant const& lhs, Rhs const& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            this->rhs_.evaluateBlock(points, result);
+            result = Operation::apply(
+                BlockArray::Constant(points.rows(), this->lhs_.constant()), result);
+        }
+
+    private:
+        Constant lhs_;
+        Rhs rhs_;
+    };
+
+    template <
+        class Operation
+    >
+    class Binary<Constant, Constant, Operation> :
+        public Expression<Binary<Constant, Constant, Operation>> {
+    public:
+        Binary(Constant const& lhs, Constant const& rhs) :
+            constant_(Operation::apply(Eigen::Array<double, 1, 1>::Constant(lhs.constant()),
+                Eigen::Array<double, 1, 1>::Constant(rhs.constant()))(0)) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            result.setConstant(this->constant_);
+        }
+
+    private:
+        double constant_;
+    };
+
+    template <
+        class Operand
+    >
+    class Shift : public Expression<Shift<Operand>> {
+    public:
+        Shift(Operand const& operand, Eigen::Ref<Eigen::ArrayXd const> const offset) :
+            operand_(operand), offset_(offset) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            if (points.cols() <= maxBlockDimension) {
+                BlockPoints shifted(points.rows(), points.cols());
+                this->evaluateShifted(points, shifted, result);
+            }
+            else {
+                Eigen::ArrayXXd shifted(points.rows(), points.cols());
+                this->evaluateShifted(points, shifted, result);
+            }
+        }
+
+    private:
+        template <
+            class Points
+        >
+        void evaluateShifted(Eigen::Ref<Eigen::ArrayXXd const> const points, Points& shifted,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            shifted = points.rowwise() - this->offset_.transpose();
+            this->operand_.evaluateBlock(shifted, result);
+        }
+
+        Operand operand_;
+        Eigen::ArrayXd offset_;
+    };
+
+    template <
+        class Operand
+    >
+    class Rotate2D : public Expression<Rotate2D<Operand>> {
+    public:
+        Rotate2D(Operand const& operand, double const angle) :
+            operand_(operand), cosine_(std::cos(angle)), sine_(std::sin(angle)) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            if (points.cols() <= maxBlockDimension) {
+                BlockPoints rotated(points.rows(), points.cols());
+                this->evaluateRotated(points, rotated, result);
+            }
+            else {
+                Eigen::ArrayXXd rotated(points.rows(), points.cols());
+                this->evaluateRotated(points, rotated, result);
+            }
+        }
+
+    private:
+        template <
+            class Points
+        >
+        void evaluateRotated(Eigen::Ref<Eigen::ArrayXXd const> const points, Points& rotated,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            rotated = points;
+            rotated.col(0) = points.col(0) * this->cosine_ + points.col(1) * this->sine_;
+            rotated.col(1) = -points.col(0) * this->sine_ + points.col(1) * this->cosine_;
+            this->operand_.evaluateBlock(rotated, result);
+        }
+
+        Operand operand_;
+        double cosine_;
+        double sine_;
+    };
+
+    // distance function for elliptical domains, given as level function,
+    // an empty midpoint or empty radii denote the origin or unit radii
+    class Elliptical : public Expression<Elliptical> {
+    public:
+        Elliptical(Eigen::Ref<Eigen::ArrayXd const> const radii,
+            Eigen::Ref<Eigen::ArrayXd const> const midpoint, double const radius=1.0) :
+            radii_(radii), midpoint_(midpoint), radius_(radius) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            result.setZero();
+            for (int dim = 0; dim < points.cols(); ++dim) {
+                double const midpoint = this->midpoint_.rows() == points.cols() ?
+                    this->midpoint_(dim) : 0.0;
+                double const radius = this->radii_.rows() == points.cols() ?
+                    this->radii_(dim) : 1.0;
+                result += ((points.col(dim) - midpoint) / radius).square();
+            }
+            result = result.sqrt() - this->radius_;
+        }
+
+    private:
+        Eigen::ArrayXd radii_;
+        Eigen::ArrayXd midpoint_;
+        double radius_;
+    };
+
+    // distance function for a nd rectangular domain
+    class Rectangular : public Expression<Rectangular> {
+    public:
+        Rectangular(Eigen::Ref<Eigen::ArrayXXd const> const rectangle) : rectangle_(rectangle) {}
+
+        void evaluateBlock(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result) const {
+            result.setConstant(INFINITY);
+            for (int dim = 0; dim < points.cols(); ++dim) {
+                result = result.min(points.col(dim) - this->rectangle_(0, dim))
+                    .min(this->rectangle_(1, dim) - points.col(dim));
+            }
+            result = -result;
+        }
+
+    private:
+        Eigen::ArrayXXd rectangle_;
+    };
+
+    // creation of primitive expressions corresponding to the distance functions
+    // in distmesh::distanceFunction, all parameters are stored by value
+    inline Constant constant(double const constant) {
+        return Constant(constant);
+    }
+    inline Elliptical elliptical(Eigen::Ref<Eigen::ArrayXd const> const radii=Eigen::ArrayXd(),
+        Eigen::Ref<Eigen::ArrayXd const> const midpoint=Eigen::ArrayXd()) {
+        return Elliptical(radii, midpoint);
+    }
+    inline Elliptical circular(double const radius=1.0,
+        Eigen::Ref<Eigen::ArrayXd const> const midpoint=Eigen::ArrayXd()) {
+        return Elliptical(Eigen::ArrayXd(), midpoint, radius);
+    }
+    inline Rectangular rectangular(Eigen::Ref<Eigen::ArrayXXd const> const rectangle) {
+        return Rectangular(rectangle);
+    }
+
+    // basic arithmetic operations
+    template <
+        class Operand
+    >
+    Unary<Operand, Negate> operator-(Expression<Operand> const& operand) {
+        return Unary<Operand, Negate>(operand.derived());
+    }
+
+    #define DISTMESH_EXPRESSION_OPERATOR(op, Operation) \
+        template <class Lhs, class Rhs> \
+        Binary<Lhs, Rhs, Operation> operator op(Expression<Lhs> const& lhs, Expression<Rhs> const& rhs) { \
+            return Binary<Lhs, Rhs, Operation>(lhs.derived(), rhs.derived()); \
+        } \
+        template <class Lhs> \
+        Binary<Lhs, Constant, Operation> operator op(Expression<Lhs> const& lhs, double const rhs) { \
+            return Binary<Lhs, Constant, Operation>(lhs.derived(), Constant(rhs)); \
+        } \
+        template <class Rhs> \
+        Binary<Constant, Rhs, Operation> operator op(double const lhs, Expression<Rhs> const& rhs) { \
+            return Binary<Constant, Rhs, Operation>(Constant(lhs), rhs.derived()); \
+        }
+
+    DISTMESH_EXPRESSION_OPERATOR(+, Sum)
+    DISTMESH_EXPRESSION_OPERATOR(-, Difference)
+    DISTMESH_EXPRESSION_OPERATOR(*, Product)
+    DISTMESH_EXPRESSION_OPERATOR(/, Quotient)
+
+    #undef DISTMESH_EXPRESSION_OPERATOR
+}
+
+// type erased fallback, which allows expressions to be combined with any
+// Functional and to be passed to the distmesh algorithm, the whole expression
+// becomes a single unnamed primitive of the expression graph
+template <
+    class Derived
+>
+Functional::Functional(expression::Expression<Derived> const& expression) {
+    auto const derived = expression.derived();
+    this->node_ = graph::primitive("", Eigen::ArrayXd(), [derived](
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result) {
+        derived.evaluate(points, result);
+    });
+}
+}
+
+#endif
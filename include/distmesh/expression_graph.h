@@ -0,0 +1,170 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#ifndef _b7c4e2d9_3f61_4a8e_95d0_6e1a8c27f4b3
+#define _b7c4e2d9_3f61_4a8e_95d0_6e1a8c27f4b3
+
+namespace distmesh {
+namespace graph {
+    // operations of the nodes of an expression graph
+    enum class Operation {
+        constant, primitive, negate, absolute, add, subtract,
+        multiply, divide, minimum, maximum, transform
+    };
+
+    // evaluates a primitive function at a block of points and stores the values in result
+    typedef std::function<void(Eigen::Ref<Eigen::ArrayXXd const> const,
+        Eigen::Ref<Eigen::ArrayXd>)> evaluator_t;
+
+    // evaluates a primitive function and its gradient at a block of points
+    typedef std::function<void(Eigen::Ref<Eigen::ArrayXXd const> const,
+        Eigen::Ref<Eigen::ArrayXd>, Eigen::Ref<Eigen::ArrayXXd>)> gradient_evaluator_t;
+
+    class Program;
+
+    // node of an expression graph, which is immutable after creation and shared
+    // between all expressions containing it
+    struct Node {
+        Node(Operation const operation) :
+            operation(operation), value(0.0), slopeBound(INFINITY) {}
+
+        Operation operation;
+        std::vector<std::shared_ptr<Node const>> operands;
+
+        // value of constant or rotation angle of transform
+        double value;
+
+        // offset of transform or parameters identifying a primitive
+        Eigen::ArrayXd parameters;
+
+        // name of primitive, unnamed primitives are only identical to themselves
+        std::string name;
+        evaluator_t evaluator;
+
+        // optional analytic gradient of primitive
+        gradient_evaluator_t gradientEvaluator;
+
+        // upper bound of the slope of primitive, infinite if unknown
+        double slopeBound;
+
+        // program compiled on first evaluation of the node as root of an expression
+        mutable std::once_flag compileFlag;
+        mutable std::unique_ptr<Program const> program;
+    };
+
+    // creation of graph nodes
+    std::shared_ptr<Node const> constant(double const value);
+    std::shared_ptr<Node const> primitive(std::string const& name,
+        Eigen::Ref<Eigen::ArrayXd const> const parameters, evaluator_t const& evaluator,
+        gradient_evaluator_t const& gradientEvaluator=gradient_evaluator_t(),
+        double const slopeBound=INFINITY);
+    std::shared_ptr<Node const> unary(Operation const operation,
+        std::shared_ptr<Node const> const& operand);
+    std::shared_ptr<Node const> binary(Operation const operation,
+        std::shared_ptr<Node const> const& lhs, std::shared_ptr<Node const> const& rhs);
+
+    // operand is evaluated at the transformed points R(angle) * x - offset,
+    // with R rotating the x-y plane by negative angle
+    std::shared_ptr<Node const> transform(std::shared_ptr<Node const> const& operand,
+        double const angle, Eigen::Ref<Eigen::ArrayXd const> const offset);
+
+    // upper bound of the slope of expression derived from the bounds of its primitives,
+    // which is infinite, if any of them is unknown or cannot be propagated
+    double slopeBound(Node const& root);
+
+    // evaluate expression given by its root node in blocks of blockSize points,
+    // which are distributed to multiple threads for parallel evaluation,
+    // compiling it on first use
+    void evaluate(Node const& root, Eigen::Ref<Eigen::ArrayXXd const> const points,
+        Eigen::Ref<Eigen::ArrayXd> result, unsigned const blockSize, bool const parallel);
+
+    // evaluate expression and its gradient by forward mode differentiation, primitives
+    // without analytic gradient are differentiated by finite differences with given step
+    void evaluate(Node const& root, Eigen::Ref<Eigen::ArrayXXd const> const points,
+        Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient,
+        double const step, unsigned const blockSize, bool const parallel);
+
+    // flat list of instructions created from an expression graph after folding
+    // constants, eliminating common subexpressions and merging transforms, which
+    // is evaluated block wise with all intermediate values kept in small registers
+    class Program {
+    public:
+        explicit Program(Node const& root);
+
+        // evaluate program for all points in blocks of blockSize points,
+        // or all points at once for zero block size, blocks are distributed
+        // to multiple threads for parallel evaluation
+        void evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result, unsigned const blockSize, bool const parallel) const;
+
+        // evaluate program and its gradient
+        void evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient,
+            double const step, unsigned const blockSize, bool const parallel) const;
+
+        // accessors
+        unsigned instructionCount() const { return this->instructions_.size(); }
+        unsigned valueRegisterCount() const { return this->valueRegisterCount_; }
+        unsigned pointRegisterCount() const { return this->pointRegisterCount_; }
+
+    private:
+        void run(Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result,
+            Eigen::Ref<Eigen::ArrayXXd> gradient, bool const withGradient, double const step,
+            unsigned blockSize, bool const parallel) const;
+
+        struct Instruction {
+            Operation operation;
+
+            // value register, or point register of transform
+            int result;
+            int lhs;
+            int rhs;
+
+            // point register primitives and transforms are evaluated at
+            int points;
+
+            // value of constant, or index of primitive or transform
+            double value;
+            int index;
+        };
+
+        struct Transform {
+            double angle;
+            Eigen::ArrayXd offset;
+        };
+
+        friend class Compiler;
+
+        std::vector<Instruction> instructions_;
+        std::vector<evaluator_t> evaluators_;
+        std::vector<gradient_evaluator_t> gradientEvaluators_;
+        std::vector<Transform> transforms_;
+
+        // point register and transform each point register is created from
+        std::vector<int> pointParents_;
+        std::vector<int> pointTransforms_;
+        unsigned valueRegisterCount_;
+        unsigned pointRegisterCount_;
+        int result_;
+    };
+}
+}
+
+#endif
@@ -21,28 +21,72 @@
 #ifndef _f2f87a1d_2511_4053_996f_1156d50b31f1
 #define _f2f87a1d_2511_4053_996f_1156d50b31f1
 
-// macro for easier creation of distmesh lambda functions
+// macro for easier creation of distmesh lambda functions,
+// for parallel evaluation the lambda is called concurrently for disjoint blocks
+// of points, so it must not modify any shared state and must not throw
 #define DISTMESH_FUNCTIONAL(function_body) \
     (distmesh::Functional([=](Eigen::Ref<Eigen::ArrayXXd const> const points) -> Eigen::ArrayXd \
         function_body))
 
 namespace distmesh {
-    // base class of all function expression for allowing easy function arithmetic
+    namespace expression {
+        template <class Derived> class Expression;
+    }
+
+    // controls the evaluation of a Functional for large arrays of points,
+    // by default all points are evaluated at once, so user defined functions
+    // are called a single time with the complete array of points
+    struct EvaluationPolicy {
+        EvaluationPolicy();
+        explicit EvaluationPolicy(unsigned const blockSize, bool const parallel=false);
+
+        // evaluate in blocks of a size, which keeps the intermediate values of
+        // typical expressions in cache, user defined functions are called once per block
+        static EvaluationPolicy blocked(bool const parallel=false);
+
+        // number of points the whole expression is evaluated for at once, such that
+        // all intermediate values stay in cache, zero evaluates all points at once
+        unsigned blockSize;
+
+        // distribute blocks to all OpenMP threads, which requires all user defined
+        // functions of the expression to be thread safe, see DISTMESH_FUNCTIONAL,
+        // has no effect when all points are evaluated as a single block
+        bool parallel;
+    };
+
+    // base class of all function expression for allowing easy function arithmetic,
+    // the expression is stored as graph, which is optimised and compiled on first evaluation
     class Functional {
     public:
         // function type of Functional callable
         typedef std::function<Eigen::ArrayXd(Eigen::Ref<Eigen::ArrayXXd const> const)> function_t;
 
         // create class from function type
-        Functional(function_t const& func) : function_(func) {}
-        Functional(double const constant) :
-            Functional(DISTMESH_FUNCTIONAL({
-                return Eigen::ArrayXd::Constant(points.rows(),constant);
-            })) {}
+        Functional(function_t const& func);
+        Functional(double const constant);
+
+        // create class from node of expression graph
+        explicit Functional(std::shared_ptr<graph::Node const> const& node) : node_(node) {}
+
+        // create class from compile time expression, see expression.h
+        template <
+            class Derived
+        >
+        Functional(expression::Expression<Derived> const& expression);
+
+        // create class from primitive function, which is identified by its name and
+        // parameters for the elimination of common subexpressions, an optional
+        // analytic gradient and an upper bound of its slope, if known
+        static Functional primitive(std::string const& name,
+            Eigen::Ref<Eigen::ArrayXd const> const parameters, graph::evaluator_t const& evaluator,
+            graph::gradient_evaluator_t const& gradientEvaluator=graph::gradient_evaluator_t(),
+            double const slopeBound=INFINITY);
 
         // copy constructor
-        Functional(Functional const& rhs) : function_(rhs.function()) {}
-        Functional(Functional&& rhs) : function_(std::move(rhs.function())) {}
+        Functional(Functional const& rhs) :
+            node_(rhs.node_), function_(std::atomic_load(&rhs.function_)) {}
+        Functional(Functional&& rhs) :
+            node_(std::move(rhs.node_)), function_(std::move(rhs.function_)) {}
 
         // assignment operator
         Functional& operator=(Functional const& rhs);
@@ -50,6 +94,18 @@ namespace distmesh {
 
         // evaluate function by call
         Eigen::ArrayXd operator() (Eigen::Ref<Eigen::ArrayXXd const> const points) const;
+        Eigen::ArrayXd operator() (Eigen::Ref<Eigen::ArrayXXd const> const points,
+            EvaluationPolicy const& policy) const;
+
+        // evaluate function and store values in result
+        void evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result,
+            EvaluationPolicy const& policy=EvaluationPolicy()) const;
+
+        // evaluate function and its gradient, parts of the expression without
+        // analytic gradient are differentiated by forward differences with given step
+        void evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result,
+            Eigen::Ref<Eigen::ArrayXXd> gradient, double const step,
+            EvaluationPolicy const& policy=EvaluationPolicy()) const;
 
         // basic arithmetic operations
         Functional operator+() const { return *this; }
@@ -84,13 +140,20 @@ namespace distmesh {
         Functional shift(Eigen::Ref<Eigen::ArrayXd const> const offset) const;
         Functional rotate2D(double const angle) const;
 
+        // upper bound of the slope of the function, infinite if unknown,
+        // true distance functions have slope one
+        double slopeBound() const;
+
         // accessors
-        function_t& function() { return this->function_; }
-        function_t const& function() const { return this->function_; }
+        function_t const& function() const;
+        std::shared_ptr<graph::Node const> const& node() const { return this->node_; }
 
     private:
-        // stores std function
-        function_t function_;
+        // root node of expression graph
+        std::shared_ptr<graph::Node const> node_;
+
+        // function object evaluating the expression, created on first request
+        mutable std::shared_ptr<function_t const> function_;
     };
 }
 
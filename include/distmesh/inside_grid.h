@@ -0,0 +1,68 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#ifndef _aed7c63e_9097_4d69_845c_8f51fade0d18
+#define _aed7c63e_9097_4d69_845c_8f51fade0d18
+
+namespace distmesh {
+namespace geometry {
+    // uniform grid over one or more closed 2d polygons with about one cell per segment,
+    // storing the segments touching each cell and whether the cell center is inside,
+    // points are classified in O(1) by counting crossings of the segment from the cell
+    // center to the point with the segments of its cell only, all queries are const
+    // and can be used concurrently
+    class InsideGrid {
+    public:
+        // create grid for closed rings given by their corner points, holes are
+        // given as additional rings and the inside is determined by the even odd rule
+        explicit InsideGrid(std::vector<Eigen::ArrayXXd> const& rings);
+
+        // 1.0 for points inside of the rings, 0.0 for points outside, points on the
+        // boundary are classified as the crossing number test of utils::pointsInsidePoly
+        // does in exact arithmetic
+        Eigen::ArrayXd pointsInside(Eigen::Ref<Eigen::ArrayXXd const> const points) const;
+
+        // accessors
+        unsigned cellCount() const { return this->columns_ * this->rows_; }
+
+    private:
+        struct Segment {
+            double a[2], b[2];
+        };
+
+        // center of grid cell
+        void cellCenter(int const column, int const row, double* const center) const;
+
+        // classify single point
+        bool isInside(double const* const point) const;
+
+        std::vector<Segment> segments_;
+
+        // segments touching each cell, with the cells numbered row by row
+        utils::Adjacency cellSegments_;
+        std::vector<bool> cellInside_;
+
+        double origin_[2], end_[2], cellSize_[2];
+        int columns_, rows_;
+    };
+}
+}
+
+#endif
@@ -0,0 +1,112 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#ifndef _e41b7c03_92d8_4f6a_b1e5_0c7d3a58f2b6
+#define _e41b7c03_92d8_4f6a_b1e5_0c7d3a58f2b6
+
+namespace distmesh {
+    // kernel used to apply the edge forces to the points
+    enum class ForceAssembly {
+        // scatter the force of each edge to both of its nodes,
+        // edges are processed in groups of conflict free colours
+        scatter,
+        // gather the forces of all adjacent edges for each node
+        gather
+    };
+
+    // time integration of the point movement caused by the edge forces
+    enum class Integrator {
+        // explicit Euler method with the fixed time step deltaT
+        euler,
+        // Euler method with a time step growing while the maximum speed of the points
+        // decreases and shrinking otherwise, limited by the maximum movement of the points
+        adaptive,
+        // heavy ball method adding a fraction of the previous movement
+        momentum,
+        // fast inertial relaxation engine, which mixes the velocity towards the force
+        // direction and adapts the time step, as long as the power is positive
+        fire
+    };
+
+    // distribution of the initial points
+    enum class Initialization {
+        // keep points of the lattice of the initial point distance randomly with
+        // a probability given by the element size function
+        rejection,
+        // Poisson disk sampling with radii given by the element size function of candidates,
+        // which are generated on coarser lattices, where the local spacing allows it,
+        // so the points are placed directly at the local spacing
+        poissonDisk
+    };
+
+    // settings of the distmesh algorithm, initialized with the default values
+    // given in constants.h, which equal the balanced preset
+    struct Options {
+        Options();
+
+        // presets trading mesh quality for runtime
+        static Options draft();
+        static Options balanced();
+        static Options production();
+
+        // get preset by its name
+        static Options preset(std::string const& name);
+
+        // algorithm stops, when maximum relative points movement is below threshold
+        double pointsMovementThreshold;
+
+        // triangulation is updated, when maximum relative points movement is above threshold
+        double retriangulationThreshold;
+
+        // time step for updating points positions with Euler's method,
+        // which is the initial time step for the other integrators
+        double deltaT;
+
+        // relative step size for numerical differentiation
+        double deltaX;
+
+        // maximum number of iterations
+        unsigned maxSteps;
+
+        // relative width of the band of points near the boundary, which are the only
+        // points checked for projection until any point moved further than the band width,
+        // the band is widened by the slope bound of the distance function and not used
+        // for an unknown slope bound, zero checks all points
+        double boundaryBandWidth;
+
+        // kernel used to apply the edge forces to the points
+        ForceAssembly forceAssembly;
+
+        // time integration of the point movement
+        Integrator integrator;
+
+        // distribution of the initial points
+        Initialization initialization;
+
+        // seed of the random selection of initial points, equal seeds give
+        // identical initial points regardless of the number of threads
+        uint64_t seed;
+
+        // evaluation of distance and element size functions
+        EvaluationPolicy evaluation;
+    };
+}
+
+#endif
@@ -0,0 +1,48 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#ifndef _3c9e1d7a_5b24_4f0e_8a61_d2f4b7c0e915
+#define _3c9e1d7a_5b24_4f0e_8a61_d2f4b7c0e915
+
+namespace distmesh {
+namespace predicates {
+    // robust geometric predicates for 2d points given as pointer to x and y coordinate,
+    // evaluated in floating point arithmetic and falling back to exact arithmetic,
+    // when the result cannot be guaranteed, following J. R. Shewchuk, Adaptive
+    // Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates, 1997
+
+    // positive, if a, b, c are in counterclockwise order, negative if clockwise,
+    // and zero if collinear
+    double orient2d(double const* const a, double const* const b, double const* const c);
+
+    // positive, if the direction vector points to the left of the line from a to b,
+    // negative if to the right, and zero if parallel, i.e. the orientation of a, b
+    // and a point infinitely far away from them in the given direction
+    double orient2dDirection(double const* const a, double const* const b,
+        double const* const direction);
+
+    // positive, if d lies inside the circle through the counterclockwise ordered
+    // points a, b, c, negative if outside, and zero if all four points are cocircular
+    double incircle(double const* const a, double const* const b, double const* const c,
+        double const* const d);
+}
+}
+
+#endif
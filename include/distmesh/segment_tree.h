@@ -0,0 +1,68 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#ifndef _3daf36ed_1300_4f8e_8041_4399f8858491
+#define _3daf36ed_1300_4f8e_8041_4399f8858491
+
+namespace distmesh {
+namespace geometry {
+    // bounding volume hierarchy over the segments of one or more closed 2d polygons,
+    // answering nearest segment queries in about O(log M) for M segments,
+    // all queries are const and can be used concurrently
+    class SegmentTree {
+    public:
+        // create tree for closed rings given by their corner points
+        explicit SegmentTree(std::vector<Eigen::ArrayXXd> const& rings);
+
+        // distance of points to the closest segment and the closest points on it
+        void closestPoints(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> distance, Eigen::Ref<Eigen::ArrayXXd> closest) const;
+
+        // accessors
+        unsigned segmentCount() const { return this->segments_.size(); }
+
+    private:
+        // segment from a to b, with a being the previous corner of the ring
+        struct Segment {
+            double ax, ay, bx, by;
+        };
+
+        // node of the tree with its bounding box, leaf nodes store a range
+        // of segments, inner nodes the index of their second child, the first
+        // child directly follows its parent
+        struct TreeNode {
+            double minX, minY, maxX, maxY;
+            int begin, end, secondChild;
+        };
+
+        // recursively create the subtree for segments in range [begin, end)
+        int build(int const begin, int const end);
+
+        // nearest segment of a single point, which is closer than distance
+        void closestPoint(double const x, double const y, double& distance,
+            double& closestX, double& closestY) const;
+
+        std::vector<Segment> segments_;
+        std::vector<TreeNode> nodes_;
+    };
+}
+}
+
+#endif
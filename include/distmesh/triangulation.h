@@ -23,8 +23,136 @@
 
 namespace distmesh {
 namespace triangulation {
-    // create delaunay triangulation from points array
+    // native incremental delaunay triangulation of 2d point sets using robust predicates,
+    // it keeps the triangulation of the last call and repairs it by local edge flips,
+    // when the points have moved, instead of rebuilding it from scratch,
+    // all points are enclosed by a triangle with symbolic vertices infinitely far away,
+    // so the triangulation always covers the convex hull of the points
+    class IncrementalDelaunay {
+    public:
+        IncrementalDelaunay() : center_(), pointCount_(0), skippedPoints_(0), randomState_(1) {}
+
+        // update triangulation to the given points positions, the previous
+        // triangulation is repaired, if the number of points did not change,
+        // otherwise or if the repair fails, it is rebuilt
+        Eigen::ArrayXXi delaunay(Eigen::Ref<Eigen::ArrayXXd const> const points);
+
+        // create triangulation from scratch by inserting points in hilbert curve order
+        void rebuild(Eigen::Ref<Eigen::ArrayXXd const> const points);
+
+        // restore delaunay property for moved points by edge flips, points
+        // crossing edges of their neighbourhood are removed and reinserted,
+        // returns false, if the triangulation cannot be repaired
+        bool repair(Eigen::Ref<Eigen::ArrayXXd const> const points);
+
+        // current triangulation without the auxiliary enclosing triangle
+        Eigen::ArrayXXi triangles() const;
+
+    private:
+        // coordinates of vertex, the directions of the enclosing triangle
+        // vertices are stored after the points
+        double const* vertex(int const index) const { return &this->coordinates_[2 * index]; }
+        bool isEnclosing(int const index) const { return index >= this->pointCount_; }
+
+        // robust predicates, which treat the vertices of the enclosing triangle
+        // as points infinitely far away in their directions
+        double orientation(int const v0, int const v1, int const v2) const;
+        double inCircle(int const v0, int const v1, int const v2, int const v3) const;
+
+        // helper for triangle connectivity, neighbours are stored opposite of vertices
+        int& triangleVertex(int const triangle, int const index) {
+            return this->vertices_[3 * triangle + index % 3];
+        }
+        int& triangleNeighbour(int const triangle, int const index) {
+            return this->neighbours_[3 * triangle + index % 3];
+        }
+        int allocateTriangle();
+        void setTriangle(int const triangle, int const v0, int const v1, int const v2,
+            int const n0, int const n1, int const n2);
+        void replaceNeighbour(int const triangle, int const oldNeighbour, int const newNeighbour);
+        int neighbourIndex(int const triangle, int const neighbour);
+        bool isInverted(int const triangle) const;
+
+        // find triangle containing vertex by a stochastic walk from given start triangle
+        int locate(int const vertex, int triangle);
+
+        // insert vertex in triangulation, returns false for duplicate points
+        bool insert(int const vertex, int& triangle);
+
+        // remove vertex from triangulation by flipping its degree down to three,
+        // returns index of the triangle filling the resulting hole
+        int remove(int const vertex);
+
+        // remove all vertices of inverted triangles at their former positions
+        // and insert them at the new ones
+        bool relocate(std::vector<int> invertedTriangles,
+            Eigen::Ref<Eigen::ArrayXXd const> const points);
+
+        // flip edge opposite of vertex index in triangle and queue surrounding edges
+        void flip(int const triangle, int const index);
+
+        // check whether flipping edge opposite of vertex index results in two valid triangles
+        bool isFlippable(int const triangle, int const index);
+
+        // flip all queued edges violating the delaunay property
+        void legalize();
+
+        // stores coordinates of all points followed by the directions of the enclosing triangle
+        std::vector<double> coordinates_;
+
+        // center of the points, which breaks ties of predicates with the enclosing triangle
+        double center_[2];
+
+        // coordinates of the last valid triangulation during repair
+        std::vector<double> previousCoordinates_;
+
+        // vertices of each triangle in counterclockwise order, -1 for unused triangles
+        std::vector<int> vertices_;
+
+        // neighbouring triangle opposite of each vertex, -1 at the boundary
+        std::vector<int> neighbours_;
+
+        // one triangle containing each vertex
+        std::vector<int> vertexTriangles_;
+
+        // unused triangles, which can be reused
+        std::vector<int> freeTriangles_;
+
+        // edges to be checked for delaunay property, given as triangle and opposite vertex index
+        std::vector<std::pair<int, int>> flipStack_;
+
+        int pointCount_;
+        int skippedPoints_;
+
+        // state of the random generator used by the stochastic walk
+        uint32_t randomState_;
+    };
+
+    // delaunay triangulation, which keeps the 2d triangulation and the point
+    // buffer between calls, 2d point sets are triangulated by the native
+    // incremental algorithm, all other ones by qhull with a new reentrant
+    // context for each run, which is freed completely afterwards, so multiple
+    // triangulators can safely be used in parallel threads with qhull >= 2019.1
+    class Triangulator {
+    public:
+        // create delaunay triangulation from points array, 2d triangulations
+        // are repaired from the previous call, whenever possible
+        Eigen::ArrayXXi delaunay(Eigen::Ref<Eigen::ArrayXXd const> const points);
+
+    private:
+        // incremental triangulation for 2d point sets
+        IncrementalDelaunay incremental_;
+
+        // points converted to row major format, as required by qhull
+        Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> pointsRowMajor_;
+    };
+
+    // create delaunay triangulation from points array using a temporary triangulator
     Eigen::ArrayXXi delaunay(Eigen::Ref<Eigen::ArrayXXd const> const points);
+
+    // create delaunay triangulation from points array by qhull for any dimension,
+    // which serves as reference for the native 2d triangulation
+    Eigen::ArrayXXi qhull(Eigen::Ref<Eigen::ArrayXXd const> const points);
 }
 }
 
@@ -69,22 +69,71 @@ namespace utils {
         }
     }
 
+    // pack edge into a single 64 bit key with the lower node index in the upper
+    // half, so ordering of keys equals lexicographic ordering of the edges
+    inline uint64_t packEdge(int const node1, int const node2) {
+        return node1 < node2 ?
+            ((uint64_t)node1 << 32) | (uint64_t)(uint32_t)node2 :
+            ((uint64_t)node2 << 32) | (uint64_t)(uint32_t)node1;
+    }
+
+    // adjacency relation stored in compressed sparse row format, the entities
+    // adjacent to entity i are indices(offsets(i)) ... indices(offsets(i + 1) - 1)
+    struct Adjacency {
+        Eigen::ArrayXi offsets;
+        Eigen::ArrayXi indices;
+
+        // number of entities adjacent to given entity
+        int count(int const entity) const {
+            return this->offsets(entity + 1) - this->offsets(entity);
+        }
+
+        // index of n-th entity adjacent to given entity
+        int operator() (int const entity, int const n) const {
+            return this->indices(this->offsets(entity) + n);
+        }
+    };
+
     // easy creation of n-dimensional bounding box
     Eigen::ArrayXXd boundingBox(unsigned const dimensions);
 
-    // create initial points distribution
+    // create initial points distribution, which is reproducible for a given seed of the options
     Eigen::ArrayXXd createInitialPoints(Functional const& distanceFunction,
         double const initialPointDistance, Functional const& elementSizeFunction,
         Eigen::Ref<Eigen::ArrayXXd const> const boundingBox,
-        Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints);
+        Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints,
+        Options const& options=Options());
 
     // create array with all unique combinations n over k
     Eigen::ArrayXXi nOverK(unsigned const n, unsigned const k);
 
+    // invert index table, i.e. create adjacency of each of the entityCount
+    // entities to all rows of the table containing it, in ascending row order
+    Adjacency invertIndexTable(Eigen::Ref<Eigen::ArrayXXi const> const table,
+        unsigned const entityCount);
+
+    // create adjacency of each node to all elements containing it
+    Adjacency nodeElementAdjacency(Eigen::Ref<Eigen::ArrayXXi const> const triangulation,
+        unsigned const nodeCount);
+
+    // create adjacency of each edge to all elements containing it
+    Adjacency edgeElementAdjacency(Eigen::Ref<Eigen::ArrayXXi const> const edgeIndices,
+        unsigned const edgeCount);
+
+    // find neighbouring element across each element edge, marked with -1 at the boundary
+    Eigen::ArrayXXi elementNeighbours(Eigen::Ref<Eigen::ArrayXXi const> const edgeIndices,
+        Adjacency const& edgeElements);
+
+    // colour edges greedily, such that no two edges of the same colour share a node,
+    // and create adjacency of each colour to all edges of that colour
+    Adjacency colourEdges(Eigen::Ref<Eigen::ArrayXXi const> const edges,
+        unsigned const nodeCount);
+
     // get a unique list of all edges in given triangulation
     Eigen::ArrayXXi findUniqueEdges(Eigen::Ref<Eigen::ArrayXXi const> const triangulation);
 
-    // get indices of bars in triangulation
+    // get indices of bars in triangulation,
+    // element edges missing in the edge list are marked with -1
     Eigen::ArrayXXi getTriangulationEdgeIndices(Eigen::Ref<Eigen::ArrayXXi const> const triangulation,
         Eigen::Ref<Eigen::ArrayXXi const> const edges);
 
@@ -103,7 +152,16 @@ namespace utils {
     void projectPointsToBoundary(Functional const& distanceFunction,
         double const initialPointDistance, Eigen::Ref<Eigen::ArrayXXd> points);
 
-    // check whether points lies inside or outside of polygon
+    // project points outside of domain back to boundary using the buffers of the workspace
+    // and the differentiation step size of the options, the gradient is only evaluated for
+    // points outside, with a boundary band given by the options only points of the band
+    // are evaluated until any point moved further than the band width
+    void projectPointsToBoundary(Functional const& distanceFunction,
+        double const initialPointDistance, Eigen::Ref<Eigen::ArrayXXd> points,
+        DistmeshWorkspace& workspace, Options const& options);
+
+    // check whether points lies inside or outside of polygon using a temporary
+    // geometry::InsideGrid, which should be kept for repeated queries
     Eigen::ArrayXd pointsInsidePoly(
         Eigen::Ref<Eigen::ArrayXXd const> const points,
         Eigen::Ref<Eigen::ArrayXXd const> const polygon);
@@ -0,0 +1,62 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#ifndef _8d1f4e26_7a3b_4c59_9e02_b5c6a1f3d874
+#define _8d1f4e26_7a3b_4c59_9e02_b5c6a1f3d874
+
+namespace distmesh {
+    // buffers needed in each step of the distmesh algorithm, which are
+    // reallocated only, when the number of points or edges changes
+    struct DistmeshWorkspace {
+        // adjust size of all buffers, keeping the memory, if sizes are unchanged
+        void resize(unsigned const pointCount, unsigned const edgeCount,
+            unsigned const dimension);
+
+        // edge quantities
+        Eigen::ArrayXXd edgeVector;
+        Eigen::ArrayXd edgeLength;
+        Eigen::ArrayXXd edgeMidpoints;
+        Eigen::ArrayXd desiredElementSize;
+        Eigen::ArrayXd desiredEdgeLength;
+        Eigen::ArrayXXd forceVector;
+
+        // point quantities
+        Eigen::ArrayXXd previousPoints;
+        Eigen::ArrayXd distance;
+        Eigen::ArrayXXd nodeForce;
+
+        // velocity of all points used by the integrators with inertia,
+        // kept across retriangulations
+        Eigen::ArrayXXd velocity;
+
+        // compact buffers of the points evaluated during projection
+        Eigen::ArrayXi candidateIndices;
+        Eigen::ArrayXXd candidatePoints;
+        Eigen::ArrayXd candidateDistance;
+        Eigen::ArrayXXd gradient;
+
+        // points near the boundary and all points positions when the band was created,
+        // kept across retriangulations
+        Eigen::ArrayXi bandIndices;
+        Eigen::ArrayXXd bandReference;
+    };
+}
+
+#endif
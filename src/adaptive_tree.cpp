@@ -0,0 +1,219 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "distmesh/distmesh.h"
+
+namespace {
+    int const maxDimension = 3;
+
+    // multilinear interpolation of the corner values of a cell at the relative
+    // position fraction and the derivatives with respect to fraction, if requested
+    double interpolateCorners(double const* const values, double const* const fraction,
+        int const dimension, double* const derivative) {
+        double value = 0.0;
+        for (int dim = 0; derivative && (dim < dimension); ++dim) {
+            derivative[dim] = 0.0;
+        }
+
+        for (int corner = 0; corner < (1 << dimension); ++corner) {
+            double weight = 1.0;
+            for (int dim = 0; dim < dimension; ++dim) {
+                weight *= (corner >> dim) & 1 ? fraction[dim] : 1.0 - fraction[dim];
+            }
+            value += weight * values[corner];
+
+            for (int dim = 0; derivative && (dim < dimension); ++dim) {
+                double partialWeight = (corner >> dim) & 1 ? 1.0 : -1.0;
+                for (int other = 0; other < dimension; ++other) {
+                    if (other != dim) {
+                        partialWeight *= (corner >> other) & 1 ? fraction[other] :
+                            1.0 - fraction[other];
+                    }
+                }
+                derivative[dim] += partialWeight * values[corner];
+            }
+        }
+
+        return value;
+    }
+}
+
+// sample function level by level
+distmesh::geometry::AdaptiveTree::AdaptiveTree(Functional const& function,
+    Eigen::Ref<Eigen::ArrayXXd const> const boundingBox, double const minimumSize,
+    double const tolerance, EvaluationPolicy const& policy) :
+    origin_(boundingBox.row(0).transpose()),
+    extent_((boundingBox.row(1) - boundingBox.row(0)).transpose()) {
+    int const dimension = boundingBox.cols();
+    if ((dimension < 1) || (dimension > maxDimension)) {
+        throw std::invalid_argument(
+            "distmesh::geometry::AdaptiveTree::AdaptiveTree: only 1d, 2d and 3d trees are supported");
+    }
+    if (minimumSize <= 0.0) {
+        throw std::invalid_argument(
+            "distmesh::geometry::AdaptiveTree::AdaptiveTree: minimum size must be positive");
+    }
+
+    // each cell of a level is checked at the 3^d points of the regular lattice with half
+    // the cell size, which contains the corners of the cell and of all its children
+    int latticeSize = 1;
+    for (int dim = 0; dim < dimension; ++dim) {
+        latticeSize *= 3;
+    }
+
+    // root cell
+    Eigen::ArrayXXd corners(1 << dimension, dimension);
+    for (int corner = 0; corner < (1 << dimension); ++corner)
+    for (int dim = 0; dim < dimension; ++dim) {
+        corners(corner, dim) = this->origin_(dim) + ((corner >> dim) & 1) * this->extent_(dim);
+    }
+    Eigen::ArrayXd cornerValues(corners.rows());
+    function.evaluate(corners, cornerValues, policy);
+    this->cells_.push_back(Cell{ -1, 0 });
+    this->values_.assign(cornerValues.data(), cornerValues.data() + cornerValues.size());
+
+    // the zero level set can only be excluded from a cell for functions with known slope bound
+    double const slopeBound = function.slopeBound();
+
+    // cells of current level, given by their index and lower corner
+    std::vector<int> level(1, 0);
+    Eigen::ArrayXXd lowerCorners = boundingBox.row(0);
+    Eigen::ArrayXd cellSize = this->extent_;
+
+    while (!level.empty() && (cellSize.maxCoeff() > minimumSize)) {
+        // evaluate function at the lattices of all cells at once
+        Eigen::ArrayXXd lattice(level.size() * latticeSize, dimension);
+        for (int cell = 0; cell < static_cast<int>(level.size()); ++cell)
+        for (int point = 0; point < latticeSize; ++point)
+        for (int dim = 0, digit = point; dim < dimension; ++dim, digit /= 3) {
+            lattice(cell * latticeSize + point, dim) = lowerCorners(cell, dim) +
+                0.5 * (digit % 3) * cellSize(dim);
+        }
+        Eigen::ArrayXd latticeValues(lattice.rows());
+        function.evaluate(lattice, latticeValues, policy);
+
+        // refine cells with large interpolation error or close to the zero level set
+        std::vector<int> nextLevel;
+        std::vector<double> nextLowerCorners;
+        double const diagonal = std::sqrt(cellSize.square().sum());
+        for (int cell = 0; cell < static_cast<int>(level.size()); ++cell) {
+            double error = 0.0;
+            double minimumValue = INFINITY;
+            for (int point = 0; point < latticeSize; ++point) {
+                double fraction[maxDimension];
+                for (int dim = 0, digit = point; dim < dimension; ++dim, digit /= 3) {
+                    fraction[dim] = 0.5 * (digit % 3);
+                }
+                double const value = latticeValues(cell * latticeSize + point);
+                error = std::max(error, std::abs(value - interpolateCorners(
+                    &this->values_[this->cells_[level[cell]].values], fraction, dimension,
+                    nullptr)));
+                minimumValue = std::min(minimumValue, std::abs(value));
+            }
+            // every point of the cell is closer than a quarter of the diagonal to one of
+            // the lattice points, so the zero level set cannot cross the cell, if all values
+            // of the lattice are larger than the change of the function along that distance
+            if ((error <= tolerance) && std::isfinite(slopeBound) &&
+                (minimumValue > 0.25 * diagonal * slopeBound)) {
+                continue;
+            }
+
+            // create children with their corner values taken from the lattice
+            this->cells_[level[cell]].firstChild = this->cells_.size();
+            for (int child = 0; child < (1 << dimension); ++child) {
+                this->cells_.push_back(Cell{ -1, static_cast<int>(this->values_.size()) });
+                for (int corner = 0; corner < (1 << dimension); ++corner) {
+                    int point = 0;
+                    for (int dim = dimension - 1; dim >= 0; --dim) {
+                        point = 3 * point + ((child >> dim) & 1) + ((corner >> dim) & 1);
+                    }
+                    this->values_.push_back(latticeValues(cell * latticeSize + point));
+                }
+
+                nextLevel.push_back(this->cells_.size() - 1);
+                for (int dim = 0; dim < dimension; ++dim) {
+                    nextLowerCorners.push_back(lowerCorners(cell, dim) +
+                        0.5 * ((child >> dim) & 1) * cellSize(dim));
+                }
+            }
+        }
+
+        level = nextLevel;
+        lowerCorners = Eigen::Map<Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
+            Eigen::RowMajor>>(nextLowerCorners.data(), level.size(), dimension);
+        cellSize *= 0.5;
+    }
+}
+
+// interpolate function at points
+void distmesh::geometry::AdaptiveTree::evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXd> result) const {
+    this->interpolate(points, result, nullptr);
+}
+
+// interpolate function and its gradient
+void distmesh::geometry::AdaptiveTree::evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient) const {
+    this->interpolate(points, result, &gradient);
+}
+
+// descend to leaf cell containing each point and interpolate its corner values
+void distmesh::geometry::AdaptiveTree::interpolate(
+    Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result,
+    Eigen::Ref<Eigen::ArrayXXd>* const gradient) const {
+    int const dimension = this->origin_.rows();
+    for (int point = 0; point < points.rows(); ++point) {
+        double lower[maxDimension], size[maxDimension];
+        for (int dim = 0; dim < dimension; ++dim) {
+            lower[dim] = this->origin_(dim);
+            size[dim] = this->extent_(dim);
+        }
+
+        int cell = 0;
+        while (this->cells_[cell].firstChild >= 0) {
+            int child = 0;
+            for (int dim = 0; dim < dimension; ++dim) {
+                size[dim] *= 0.5;
+                if (points(point, dim) >= lower[dim] + size[dim]) {
+                    child |= 1 << dim;
+                    lower[dim] += size[dim];
+                }
+            }
+            cell = this->cells_[cell].firstChild + child;
+        }
+
+        double fraction[maxDimension], derivative[maxDimension];
+        for (int dim = 0; dim < dimension; ++dim) {
+            fraction[dim] = (points(point, dim) - lower[dim]) / size[dim];
+        }
+        result(point) = interpolateCorners(&this->values_[this->cells_[cell].values], fraction,
+            dimension, gradient ? derivative : nullptr);
+
+        if (gradient) {
+            for (int dim = 0; dim < dimension; ++dim) {
+                (*gradient)(point, dim) = derivative[dim] / size[dim];
+            }
+        }
+    }
+}
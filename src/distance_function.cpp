@@ -18,34 +18,148 @@
 // Contact: patrik.gebhardt@rub.de
 // --------------------------------------------------------------------
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
 #include "distmesh/distmesh.h"
 
+namespace {
+    // parameters of primitive given by an array, including its shape
+    Eigen::ArrayXd arrayParameters(Eigen::Ref<Eigen::ArrayXXd const> const array) {
+        Eigen::ArrayXd parameters(array.size() + 2);
+        parameters(0) = array.rows();
+        parameters(1) = array.cols();
+        for (int col = 0; col < array.cols(); ++col) {
+            parameters.segment(2 + col * array.rows(), array.rows()) = array.col(col);
+        }
+
+        return parameters;
+    }
+
+    // values of a function sampled at the nodes of a regular grid, stored with
+    // the first dimension running fastest
+    struct SampledGrid {
+        static int const maxDimension = 3;
+
+        // multilinear interpolation of the values of the grid cell containing each point,
+        // points outside of the grid are extrapolated from the nearest cell
+        void interpolate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+            Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd>* const gradient) const {
+            int const dimension = this->origin.rows();
+            for (int point = 0; point < points.rows(); ++point) {
+                // cell of point and relative position inside of it
+                double fraction[maxDimension];
+                int64_t index = 0;
+                for (int dim = 0; dim < dimension; ++dim) {
+                    double const position = (points(point, dim) - this->origin(dim)) /
+                        this->spacing(dim);
+                    int64_t const cell = static_cast<int64_t>(std::min(std::max(std::floor(position),
+                        0.0), static_cast<double>(this->size(dim) - 2)));
+                    fraction[dim] = position - cell;
+                    index += cell * this->stride(dim);
+                }
+
+                // sum up contributions of all corners of the cell
+                double value = 0.0, derivative[maxDimension] = { 0.0, 0.0, 0.0 };
+                for (int corner = 0; corner < (1 << dimension); ++corner) {
+                    double weight = 1.0;
+                    int64_t offset = 0;
+                    for (int dim = 0; dim < dimension; ++dim) {
+                        int const bit = (corner >> dim) & 1;
+                        weight *= bit ? fraction[dim] : 1.0 - fraction[dim];
+                        offset += bit * this->stride(dim);
+                    }
+                    double const cornerValue = this->values(index + offset);
+                    value += weight * cornerValue;
+
+                    if (gradient) {
+                        for (int dim = 0; dim < dimension; ++dim) {
+                            double partialWeight = ((corner >> dim) & 1 ? 1.0 : -1.0) /
+                                this->spacing(dim);
+                            for (int other = 0; other < dimension; ++other) {
+                                if (other != dim) {
+                                    partialWeight *= (corner >> other) & 1 ? fraction[other] :
+                                        1.0 - fraction[other];
+                                }
+                            }
+                            derivative[dim] += partialWeight * cornerValue;
+                        }
+                    }
+                }
+
+                result(point) = value;
+                if (gradient) {
+                    for (int dim = 0; dim < dimension; ++dim) {
+                        (*gradient)(point, dim) = derivative[dim];
+                    }
+                }
+            }
+        }
+
+        Eigen::ArrayXd origin;
+        Eigen::ArrayXd spacing;
+        Eigen::Array<int64_t, Eigen::Dynamic, 1> size;
+        Eigen::Array<int64_t, Eigen::Dynamic, 1> stride;
+        Eigen::ArrayXd values;
+    };
+}
+
 // creates distance function for a nd rectangular domain
 distmesh::Functional distmesh::distanceFunction::rectangular(
     Eigen::Ref<Eigen::ArrayXXd const> const rectangle) {
-    return DISTMESH_FUNCTIONAL({
-        Eigen::ArrayXXd result = (points.col(0) - rectangle(0, 0))
-            .min(rectangle(1, 0) - points.col(0));
+    Eigen::ArrayXXd const box = rectangle;
+
+    return Functional::primitive("rectangular", arrayParameters(box), [box](
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result) {
+        result = (points.col(0) - box(0, 0)).min(box(1, 0) - points.col(0));
 
         for (int dim = 1; dim < points.cols(); ++dim) {
             result = result
-                .min((points.col(dim) - rectangle(0, dim)))
-                .min(rectangle(1, dim) - points.col(dim));
+                .min((points.col(dim) - box(0, dim)))
+                .min(box(1, dim) - points.col(dim));
         }
 
-        return -result;
-    });
+        result = -result;
+    }, [box](Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result,
+        Eigen::Ref<Eigen::ArrayXXd> gradient) {
+        // gradient is the outer normal of the closest side
+        gradient.setZero();
+        for (int point = 0; point < points.rows(); ++point) {
+            result(point) = INFINITY;
+            int side = 0;
+            double normal = 0.0;
+            for (int dim = 0; dim < points.cols(); ++dim) {
+                if (points(point, dim) - box(0, dim) < result(point)) {
+                    result(point) = points(point, dim) - box(0, dim);
+                    side = dim;
+                    normal = -1.0;
+                }
+                if (box(1, dim) - points(point, dim) < result(point)) {
+                    result(point) = box(1, dim) - points(point, dim);
+                    side = dim;
+                    normal = 1.0;
+                }
+            }
+            result(point) = -result(point);
+            gradient(point, side) = normal;
+        }
+    }, 1.0);
 }
 
 // creates the true distance function for a 2d rectangular domain
 distmesh::Functional distmesh::distanceFunction::rectangle(
     Eigen::Ref<Eigen::ArrayXXd const> const rectangle) {
-    return DISTMESH_FUNCTIONAL({
+    Eigen::ArrayXXd const box = rectangle;
+
+    return Functional::primitive("rectangle", arrayParameters(box), [box](
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result) {
         // distances to all 4 sides of rectangle
-        auto d1 = rectangle(0, 1) - points.col(1);
-        auto d2 = -rectangle(1, 1) + points.col(1);
-        auto d3 = rectangle(0, 0) - points.col(0);
-        auto d4 = -rectangle(1, 0) + points.col(0);
+        auto d1 = box(0, 1) - points.col(1);
+        auto d2 = -box(1, 1) + points.col(1);
+        auto d3 = box(0, 0) - points.col(0);
+        auto d4 = -box(1, 0) + points.col(0);
 
         // distances to all 4 corners of rectangle
         auto d5 = (d1.square() + d3.square()).sqrt();
@@ -54,89 +168,252 @@ distmesh::Functional distmesh::distanceFunction::rectangle(
         auto d8 = (d2.square() + d4.square()).sqrt();
 
         // distance to neares side of rectangle
-        Eigen::ArrayXd d = -(-d1).min(-d2).min(-d3).min(-d4);
+        result = -(-d1).min(-d2).min(-d3).min(-d4);
 
         // check if smallest distance is to one of the corners
-        d = (d1 > 0.0 && d3 > 0.0).select(d5, d);
-        d = (d1 > 0.0 && d4 > 0.0).select(d6, d);
-        d = (d2 > 0.0 && d3 > 0.0).select(d7, d);
-        d = (d2 > 0.0 && d4 > 0.0).select(d8, d);
+        result = (d1 > 0.0 && d3 > 0.0).select(d5, result);
+        result = (d1 > 0.0 && d4 > 0.0).select(d6, result);
+        result = (d2 > 0.0 && d3 > 0.0).select(d7, result);
+        result = (d2 > 0.0 && d4 > 0.0).select(d8, result);
+    }, [box](Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result,
+        Eigen::Ref<Eigen::ArrayXXd> gradient) {
+        for (int point = 0; point < points.rows(); ++point) {
+            // distances to all 4 sides of rectangle
+            double const d1 = box(0, 1) - points(point, 1);
+            double const d2 = -box(1, 1) + points(point, 1);
+            double const d3 = box(0, 0) - points(point, 0);
+            double const d4 = -box(1, 0) + points(point, 0);
 
-        return d;
-    });
+            // distance and outer normal of nearest side
+            result(point) = std::max(std::max(d1, d2), std::max(d3, d4));
+            if (result(point) == d1) {
+                gradient.row(point) << 0.0, -1.0;
+            }
+            else if (result(point) == d2) {
+                gradient.row(point) << 0.0, 1.0;
+            }
+            else if (result(point) == d3) {
+                gradient.row(point) << -1.0, 0.0;
+            }
+            else {
+                gradient.row(point) << 1.0, 0.0;
+            }
+
+            // distance to one of the corners
+            if ((d1 > 0.0 || d2 > 0.0) && (d3 > 0.0 || d4 > 0.0)) {
+                double const dy = d1 > 0.0 ? -d1 : d2;
+                double const dx = d3 > 0.0 ? -d3 : d4;
+                result(point) = std::sqrt(dx * dx + dy * dy);
+                gradient.row(point) << dx / result(point), dy / result(point);
+            }
+        }
+    }, 1.0);
 }
 
 // creates distance function for elliptical domains
 distmesh::Functional distmesh::distanceFunction::elliptical(
     Eigen::Ref<Eigen::ArrayXd const> const radii,
     Eigen::Ref<Eigen::ArrayXd const> const midpoint) {
-    return DISTMESH_FUNCTIONAL({
-        if (midpoint.rows() == points.cols()) {
-            if (radii.rows() == points.cols()) {
-                return ((points.rowwise() - midpoint.transpose()).rowwise() / radii.transpose())
+    Eigen::ArrayXd const r = radii, m = midpoint;
+    Eigen::ArrayXd parameters(r.rows() + m.rows() + 1);
+    parameters << r.rows(), r, m;
+
+    // slope of the scaled norm is bounded by the inverse of the smallest radius
+    double const slopeBound = r.rows() > 0 ? std::max(1.0, 1.0 / r.minCoeff()) : 1.0;
+
+    return Functional::primitive("elliptical", parameters, [r, m](
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result) {
+        if (m.rows() == points.cols()) {
+            if (r.rows() == points.cols()) {
+                result = ((points.rowwise() - m.transpose()).rowwise() / r.transpose())
                     .square().rowwise().sum().sqrt() - 1.0;
             }
             else {
-                return (points.rowwise() - midpoint.transpose())
+                result = (points.rowwise() - m.transpose())
                     .square().rowwise().sum().sqrt() - 1.0;
             }
         }
         else {
-            if (radii.rows() == points.cols()) {
-                return (points.rowwise() / radii.transpose())
+            if (r.rows() == points.cols()) {
+                result = (points.rowwise() / r.transpose())
                     .square().rowwise().sum().sqrt() - 1.0;
             }
             else {
-                return points.square().rowwise().sum().sqrt() - 1.0;
+                result = points.square().rowwise().sum().sqrt() - 1.0;
             }
         }
-    });
+    }, [r, m](Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result,
+        Eigen::Ref<Eigen::ArrayXXd> gradient) {
+        Eigen::ArrayXXd scaled = points;
+        if (m.rows() == points.cols()) {
+            scaled = scaled.rowwise() - m.transpose();
+        }
+        if (r.rows() == points.cols()) {
+            scaled = scaled.rowwise() / r.transpose();
+        }
+        Eigen::ArrayXd const norm = scaled.square().rowwise().sum().sqrt();
+        result = norm - 1.0;
+
+        // gradient of the scaled norm, which vanishes at the midpoint
+        gradient = scaled.colwise() / (norm > 0.0).select(norm, 1.0);
+        if (r.rows() == points.cols()) {
+            gradient = gradient.rowwise() / r.transpose();
+        }
+    }, slopeBound);
 }
 
 // creates the true distance function for circular domains
 distmesh::Functional
     distmesh::distanceFunction::circular(double const radius,
     Eigen::Ref<Eigen::ArrayXd const> const midpoint) {
-    return DISTMESH_FUNCTIONAL({
-        if (midpoint.rows() == points.cols()) {
-            return (points.rowwise() - midpoint.transpose())
+    Eigen::ArrayXd const m = midpoint;
+    Eigen::ArrayXd parameters(m.rows() + 1);
+    parameters << radius, m;
+
+    return Functional::primitive("circular", parameters, [radius, m](
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result) {
+        if (m.rows() == points.cols()) {
+            result = (points.rowwise() - m.transpose())
                 .square().rowwise().sum().sqrt() - radius;
         }
         else {
-            return points.square().rowwise().sum().sqrt() - radius;
+            result = points.square().rowwise().sum().sqrt() - radius;
         }
-    });
+    }, [radius, m](Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result,
+        Eigen::Ref<Eigen::ArrayXXd> gradient) {
+        Eigen::ArrayXXd centered = points;
+        if (m.rows() == points.cols()) {
+            centered = centered.rowwise() - m.transpose();
+        }
+        Eigen::ArrayXd const norm = centered.square().rowwise().sum().sqrt();
+        result = norm - radius;
+
+        // radial direction, which vanishes at the midpoint
+        gradient = centered.colwise() / (norm > 0.0).select(norm, 1.0);
+    }, 1.0);
 }
 
 // creates distance function for a 2d domain described by polygon
 distmesh::Functional distmesh::distanceFunction::polygon(
     Eigen::Ref<Eigen::ArrayXXd const> const polygon) {
-    return DISTMESH_FUNCTIONAL({
-        Eigen::ArrayXXd v(points.rows(), 2);
-        Eigen::ArrayXXd w(points.rows(), 2);
-        Eigen::ArrayXXd c1(points.rows(), 1);
-        Eigen::ArrayXXd c2(points.rows(), 1);
-        Eigen::ArrayXXd distance(points.rows(), polygon.rows());
-
-        for (int i = 0, j = polygon.rows() - 1;
-            i < polygon.rows(); j = i++) {
-            v.rowwise() = polygon.row(i) - polygon.row(j);
-            w = points.rowwise() - polygon.row(j);
-
-            c1 = v.col(0) * w.col(0) + v.col(1) * w.col(1);
-            c2 = v.col(0) * v.col(0) + v.col(1) * v.col(1);
-
-            distance.col(i) =
-                (c1 <= 0.0).select(
-                    (points.rowwise() - polygon.row(j)).square().rowwise().sum().sqrt(),
-                (c1 >= c2).select(
-                    (points.rowwise() - polygon.row(i)).square().rowwise().sum().sqrt(),
-                    (points - ((v.colwise() * (c1 / c2).col(0)).rowwise() + polygon.row(j)))
-                        .square().rowwise().sum().sqrt()
-                ));
+    return distanceFunction::polygon(std::vector<Eigen::ArrayXXd>(1, polygon));
+}
+
+// creates distance function for a 2d domain described by multiple closed rings
+distmesh::Functional distmesh::distanceFunction::polygon(
+    std::vector<Eigen::ArrayXXd> const& rings) {
+    // parameters are the number of rings followed by all rings
+    std::vector<Eigen::ArrayXd> ringParameters;
+    int parameterCount = 1;
+    for (auto const& ring : rings) {
+        ringParameters.push_back(arrayParameters(ring));
+        parameterCount += ringParameters.back().rows();
+    }
+    Eigen::ArrayXd parameters(parameterCount);
+    parameters(0) = rings.size();
+    for (int ring = 0, start = 1; ring < static_cast<int>(ringParameters.size()); ++ring) {
+        parameters.segment(start, ringParameters[ring].rows()) = ringParameters[ring];
+        start += ringParameters[ring].rows();
+    }
+
+    // tree and grid are shared by all copies of the function
+    auto const tree = std::make_shared<geometry::SegmentTree const>(rings);
+    auto const grid = std::make_shared<geometry::InsideGrid const>(rings);
+
+    return Functional::primitive("polygon", parameters, [tree, grid](
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result) {
+        Eigen::ArrayXXd closest(points.rows(), 2);
+        tree->closestPoints(points, result, closest);
+
+        result *= 1.0 - 2.0 * grid->pointsInside(points);
+    }, [tree, grid](Eigen::Ref<Eigen::ArrayXXd const> const points,
+        Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient) {
+        Eigen::ArrayXXd closest(points.rows(), 2);
+        tree->closestPoints(points, result, closest);
+
+        // gradient points away from the closest point on the boundary to the outside
+        Eigen::ArrayXd const sign = 1.0 - 2.0 * grid->pointsInside(points);
+        gradient = (points - closest).colwise() * (sign / (result > 0.0).select(result, 1.0));
+        result *= sign;
+    }, 1.0);
+}
+
+// samples function at the nodes of a regular grid and interpolates it multilinearly
+distmesh::Functional distmesh::distanceFunction::sampled(Functional const& function,
+    Eigen::Ref<Eigen::ArrayXXd const> const boundingBox, double const resolution,
+    EvaluationPolicy const& policy) {
+    if ((boundingBox.cols() < 1) || (boundingBox.cols() > SampledGrid::maxDimension)) {
+        throw std::invalid_argument(
+            "distmesh::distanceFunction::sampled: only 1d, 2d and 3d grids are supported");
+    }
+    if (!(resolution > 0.0)) {
+        throw std::invalid_argument(
+            "distmesh::distanceFunction::sampled: resolution must be positive");
+    }
+    if (!((boundingBox.row(1) - boundingBox.row(0)) > 0.0).all()) {
+        throw std::invalid_argument(
+            "distmesh::distanceFunction::sampled: bounding box must have positive extent");
+    }
+
+    // create grid with at least one cell and two nodes per dimension
+    auto grid = std::make_shared<SampledGrid>();
+    grid->origin = boundingBox.row(0).transpose();
+    grid->size.resize(boundingBox.cols());
+    grid->stride.resize(boundingBox.cols());
+    grid->spacing.resize(boundingBox.cols());
+    int64_t nodeCount = 1;
+    for (int dim = 0; dim < boundingBox.cols(); ++dim) {
+        double const extent = boundingBox(1, dim) - boundingBox(0, dim);
+        double const size = std::max(std::ceil(extent / resolution), 1.0) + 1.0;
+        if (!(size * nodeCount <= static_cast<double>(std::numeric_limits<Eigen::Index>::max()))) {
+            throw std::invalid_argument(
+                "distmesh::distanceFunction::sampled: too many grid nodes for given resolution");
         }
+        grid->size(dim) = static_cast<int64_t>(size);
+        grid->spacing(dim) = extent / (grid->size(dim) - 1);
+        grid->stride(dim) = nodeCount;
+        nodeCount *= grid->size(dim);
+    }
+
+    // sample function in chunks of nodes to limit the memory of the node coordinates
+    grid->values.resize(nodeCount);
+    int64_t const chunkSize = 1 << 16;
+    Eigen::ArrayXXd nodes(std::min(chunkSize, nodeCount), boundingBox.cols());
+    for (int64_t start = 0; start < nodeCount; start += chunkSize) {
+        int64_t const rows = std::min(chunkSize, nodeCount - start);
+        for (int64_t node = 0; node < rows; ++node)
+        for (int dim = 0; dim < boundingBox.cols(); ++dim) {
+            nodes(node, dim) = grid->origin(dim) + grid->spacing(dim) *
+                (((start + node) / grid->stride(dim)) % grid->size(dim));
+        }
+
+        function.evaluate(nodes.topRows(rows), grid->values.segment(start, rows), policy);
+    }
+
+    // grid is shared by all copies of the function and only identical to itself
+    std::shared_ptr<SampledGrid const> const sampledGrid = grid;
+    return Functional::primitive("", Eigen::ArrayXd(), [sampledGrid](
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result) {
+        sampledGrid->interpolate(points, result, nullptr);
+    }, [sampledGrid](Eigen::Ref<Eigen::ArrayXXd const> const points,
+        Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient) {
+        sampledGrid->interpolate(points, result, &gradient);
+    });
+}
+
+// caches function in an adaptive tree
+distmesh::Functional distmesh::distanceFunction::adaptive(Functional const& function,
+    Eigen::Ref<Eigen::ArrayXXd const> const boundingBox, double const minimumSize,
+    double const tolerance, EvaluationPolicy const& policy) {
+    // tree is shared by all copies of the function and only identical to itself
+    auto const tree = std::make_shared<geometry::AdaptiveTree const>(function, boundingBox,
+        minimumSize, tolerance, policy);
 
-        return (1.0 - 2.0 * utils::pointsInsidePoly(points, polygon)) *
-            distance.rowwise().minCoeff();
+    return Functional::primitive("", Eigen::ArrayXd(), [tree](
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result) {
+        tree->evaluate(points, result);
+    }, [tree](Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result,
+        Eigen::Ref<Eigen::ArrayXXd> gradient) {
+        tree->evaluate(points, result, gradient);
     });
 }
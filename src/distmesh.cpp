@@ -21,41 +21,117 @@
 #include <vector>
 #include <set>
 #include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 #include "distmesh/distmesh.h"
 #include "distmesh/constants.h"
 #include "distmesh/triangulation.h"
 
+namespace {
+    // parameters of the integrators, time steps are limited to a multiple of deltaT,
+    // the one of the fire integrator is the square root of it, to move points
+    // initially as far as the Euler method
+    double const maxTimeStepFactor = 10.0;
+    double const adaptiveIncrease = 1.1;
+    double const adaptiveDecrease = 0.5;
+    double const adaptiveMaxMovement = 0.2;
+    double const momentum = 0.7;
+    unsigned const fireMinSteps = 5;
+    double const fireIncrease = 1.1;
+    double const fireDecrease = 0.5;
+    double const fireAlphaStart = 0.1;
+    double const fireAlphaDecrease = 0.99;
+}
+
 // apply the distmesh algorithm
 std::tuple<Eigen::ArrayXXd, Eigen::ArrayXXi> distmesh::distmesh(
     Functional const& distanceFunction, double const initialPointDistance,
     Functional const& elementSizeFunction, Eigen::Ref<Eigen::ArrayXXd const> const boundingBox,
-    Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints) {
-    // determine dimension of mesh
-    unsigned const dimension = boundingBox.cols();
-
+    Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints, Options const& options) {
     // create initial distribution in bounding box
     Eigen::ArrayXXd points = utils::createInitialPoints(distanceFunction,
-        initialPointDistance, elementSizeFunction, boundingBox, fixedPoints);
+        initialPointDistance, elementSizeFunction, boundingBox, fixedPoints, options);
 
-    // create initial triangulation
-    Eigen::ArrayXXi triangulation = triangulation::delaunay(points);
+    return relax(distanceFunction, initialPointDistance, elementSizeFunction, points,
+        fixedPoints.rows(), options);
+}
+
+// relax given points with the distmesh algorithm
+std::tuple<Eigen::ArrayXXd, Eigen::ArrayXXi> distmesh::relax(
+    Functional const& distanceFunction, double const initialPointDistance,
+    Functional const& elementSizeFunction, Eigen::Ref<Eigen::ArrayXXd const> const initialPoints,
+    int const fixedPointCount, Options const& options) {
+    // determine dimension of mesh
+    unsigned const dimension = initialPoints.cols();
+    Eigen::ArrayXXd points = initialPoints;
+
+    // create initial triangulation with a triangulator owned by this call,
+    // which reuses its qhull context for all retriangulations
+    triangulation::Triangulator triangulator;
+    Eigen::ArrayXXi triangulation = triangulator.delaunay(points);
 
     // create buffer to store old point locations to calculate
     // retriangulation and stop criterion
     Eigen::ArrayXXd retriangulationCriterionBuffer = Eigen::ArrayXXd::Constant(
         points.rows(), points.cols(), INFINITY);
-    Eigen::ArrayXXd stopCriterionBuffer = Eigen::ArrayXXd::Zero(
-        points.rows(), points.cols());
+
+    // buffers reused in every step of the main loop
+    DistmeshWorkspace workspace;
 
     // main distmesh loop
     Eigen::ArrayXXi edgeIndices;
-    for (unsigned step = 0; step < constants::maxSteps; ++step) {
+    utils::Adjacency edgeColours, nodeEdges;
+
+    // add scaled force vectors of all edges to their nodes, except the fixed ones
+    auto const applyForces = [&](Eigen::Ref<Eigen::ArrayXXd> target, double const scale) {
+        if (options.forceAssembly == ForceAssembly::gather) {
+            // sum up forces of all edges adjacent to each node
+            #pragma omp parallel for
+            for (int node = fixedPointCount; node < target.rows(); ++node)
+            for (int n = 0; n < nodeEdges.count(node); ++n) {
+                auto const edge = nodeEdges(node, n);
+                if (edgeIndices(edge, 0) == node) {
+                    target.row(node) += scale * workspace.forceVector.row(edge);
+                }
+                else {
+                    target.row(node) -= scale * workspace.forceVector.row(edge);
+                }
+            }
+        }
+        else {
+            // edges of the same colour share no node and can be
+            // processed concurrently without write conflicts
+            for (int colour = 0; colour < edgeColours.offsets.rows() - 1; ++colour) {
+                #pragma omp parallel for
+                for (int n = 0; n < edgeColours.count(colour); ++n) {
+                    auto const edge = edgeColours(colour, n);
+                    if (edgeIndices(edge, 0) >= fixedPointCount) {
+                        target.row(edgeIndices(edge, 0)) += scale * workspace.forceVector.row(edge);
+                    }
+                    if (edgeIndices(edge, 1) >= fixedPointCount) {
+                        target.row(edgeIndices(edge, 1)) -= scale * workspace.forceVector.row(edge);
+                    }
+                }
+            }
+        }
+    };
+
+    // state of the integrators
+    workspace.velocity = Eigen::ArrayXXd::Zero(points.rows(), dimension);
+    double const minTimeStep = options.integrator == Integrator::fire ?
+        std::sqrt(options.deltaT) : options.deltaT;
+    double const maxTimeStep = options.integrator == Integrator::fire ?
+        std::sqrt(maxTimeStepFactor * options.deltaT) : maxTimeStepFactor * options.deltaT;
+    double timeStep = minTimeStep, previousMaxSpeed = INFINITY;
+    double fireAlpha = fireAlphaStart;
+    unsigned stepsSinceRestart = 0;
+    for (unsigned step = 0; step < options.maxSteps; ++step) {
         // retriangulate if point movement is above threshold
         if ((points - retriangulationCriterionBuffer).square().rowwise().sum().sqrt().maxCoeff() >
-            constants::retriangulationThreshold * initialPointDistance) {
+            options.retriangulationThreshold * initialPointDistance) {
             // update triangulation
-            triangulation = triangulation::delaunay(points);
+            triangulation = triangulator.delaunay(points);
 
             // reject triangles with circumcenter outside of the region
             Eigen::ArrayXXd circumcenter = Eigen::ArrayXXd::Zero(triangulation.rows(), dimension);
@@ -64,56 +140,183 @@ std::tuple<Eigen::ArrayXXd, Eigen::ArrayXXi> distmesh::distmesh(
                     points, triangulation.col(point)) / triangulation.cols();
             }
             triangulation = utils::selectMaskedArrayElements<int>(triangulation,
-                distanceFunction(circumcenter) < -constants::geometryEvaluationThreshold * initialPointDistance);
+                distanceFunction(circumcenter, options.evaluation) <
+                -constants::geometryEvaluationThreshold * initialPointDistance);
 
             // find unique edge indices
             edgeIndices = utils::findUniqueEdges(triangulation);
+            if (options.forceAssembly == ForceAssembly::gather) {
+                nodeEdges = utils::invertIndexTable(edgeIndices, points.rows());
+            }
+            else {
+                edgeColours = utils::colourEdges(edgeIndices, points.rows());
+            }
 
             // store current points positions
             retriangulationCriterionBuffer = points;
+
+            // adjust buffers to new number of edges
+            workspace.resize(points.rows(), edgeIndices.rows(), dimension);
         }
 
-        // calculate edge vectors and their length
-        auto const edgeVector = (utils::selectIndexedArrayElements<double>(points, edgeIndices.col(0)) -
-            utils::selectIndexedArrayElements<double>(points, edgeIndices.col(1))).eval();
-        auto const edgeLength = edgeVector.square().rowwise().sum().sqrt().eval();
+        // calculate edge vectors, their length and midpoints
+        #pragma omp parallel for
+        for (int edge = 0; edge < edgeIndices.rows(); ++edge) {
+            workspace.edgeVector.row(edge) = points.row(edgeIndices(edge, 0)) -
+                points.row(edgeIndices(edge, 1));
+            workspace.edgeLength(edge) = std::sqrt(workspace.edgeVector.row(edge).square().sum());
+            workspace.edgeMidpoints.row(edge) = 0.5 * (points.row(edgeIndices(edge, 0)) +
+                points.row(edgeIndices(edge, 1)));
+        }
 
         // evaluate elementSizeFunction at midpoints of edges
-        auto const desiredElementSize = elementSizeFunction(0.5 *
-            (utils::selectIndexedArrayElements<double>(points, edgeIndices.col(0)) +
-            utils::selectIndexedArrayElements<double>(points, edgeIndices.col(1)))).eval();
+        elementSizeFunction.evaluate(workspace.edgeMidpoints, workspace.desiredElementSize,
+            options.evaluation);
 
         // calculate desired edge length
-        auto const desiredEdgeLength = (desiredElementSize * (1.0 + 0.4 / std::pow(2.0, dimension - 1)) *
-            std::pow((edgeLength.pow(dimension).sum() / desiredElementSize.pow(dimension).sum()),
-                1.0 / dimension)).eval();
+        workspace.desiredEdgeLength = workspace.desiredElementSize *
+            (1.0 + 0.4 / std::pow(2.0, dimension - 1)) *
+            std::pow((workspace.edgeLength.pow(dimension).sum() /
+                workspace.desiredElementSize.pow(dimension).sum()), 1.0 / dimension);
 
         // calculate force vector for each edge
-        auto const forceVector = (edgeVector.colwise() *
-            ((desiredEdgeLength - edgeLength) / edgeLength).max(0.0)).eval();
+        #pragma omp parallel for
+        for (int edge = 0; edge < edgeIndices.rows(); ++edge) {
+            workspace.forceVector.row(edge) = workspace.edgeVector.row(edge) *
+                std::max((workspace.desiredEdgeLength(edge) - workspace.edgeLength(edge)) /
+                    workspace.edgeLength(edge), 0.0);
+        }
 
         // store current points positions
-        stopCriterionBuffer = points;
+        workspace.previousPoints = points;
 
         // move points
-        for (int edge = 0; edge < edgeIndices.rows(); ++edge) {
-            if (edgeIndices(edge, 0) >= fixedPoints.rows()) {
-                points.row(edgeIndices(edge, 0)) += constants::deltaT * forceVector.row(edge);
+        if (options.integrator == Integrator::euler) {
+            applyForces(points, options.deltaT);
+
+            // project points outside of domain to boundary
+            utils::projectPointsToBoundary(distanceFunction, initialPointDistance, points, workspace, options);
+        }
+        else {
+            workspace.nodeForce.setZero();
+            applyForces(workspace.nodeForce, 1.0);
+
+            if (options.integrator == Integrator::adaptive) {
+                points += timeStep * workspace.nodeForce;
             }
-            if (edgeIndices(edge, 1) >= fixedPoints.rows()) {
-                points.row(edgeIndices(edge, 1)) -= constants::deltaT * forceVector.row(edge);
+            else if (options.integrator == Integrator::momentum) {
+                workspace.velocity = momentum * workspace.velocity + options.deltaT * workspace.nodeForce;
+                points += workspace.velocity;
+            }
+            else {
+                // mix velocity towards force direction, while the power is positive,
+                // or stop all points and restart with a smaller time step, when it is negative
+                double const power = (workspace.velocity * workspace.nodeForce).sum();
+                if (power > 0.0) {
+                    double const forceNorm = std::sqrt(workspace.nodeForce.square().sum());
+                    workspace.velocity = (1.0 - fireAlpha) * workspace.velocity + fireAlpha *
+                        std::sqrt(workspace.velocity.square().sum()) / forceNorm * workspace.nodeForce;
+                    if (++stepsSinceRestart > fireMinSteps) {
+                        timeStep = std::min(timeStep * fireIncrease, maxTimeStep);
+                        fireAlpha *= fireAlphaDecrease;
+                    }
+                }
+                else if (power < 0.0) {
+                    workspace.velocity.setZero();
+                    timeStep = std::max(timeStep * fireDecrease, minTimeStep);
+                    fireAlpha = fireAlphaStart;
+                    stepsSinceRestart = 0;
+                }
+
+                workspace.velocity += timeStep * workspace.nodeForce;
+                points += timeStep * workspace.velocity;
             }
-        }
 
-        // project points outside of domain to boundary
-        utils::projectPointsToBoundary(distanceFunction, initialPointDistance, points);
+            // project points outside of domain to boundary
+            utils::projectPointsToBoundary(distanceFunction, initialPointDistance, points, workspace, options);
+
+            // adapt time step to the maximum speed of the points after projection,
+            // which excludes the forces pushing points against the boundary
+            if (options.integrator == Integrator::adaptive) {
+                double const maxSpeed = (points - workspace.previousPoints).square().rowwise().sum()
+                    .sqrt().maxCoeff() / timeStep;
+                timeStep = maxSpeed < previousMaxSpeed ?
+                    std::min(timeStep * adaptiveIncrease, maxTimeStep) :
+                    std::max(timeStep * adaptiveDecrease, minTimeStep);
+                timeStep = std::max(std::min(timeStep, adaptiveMaxMovement * initialPointDistance /
+                    maxSpeed), minTimeStep);
+                previousMaxSpeed = maxSpeed;
+            }
+
+            // remove velocity lost by projection to boundary
+            if (options.integrator == Integrator::momentum) {
+                workspace.velocity = points - workspace.previousPoints;
+            }
+            else if (options.integrator == Integrator::fire) {
+                workspace.velocity = (points - workspace.previousPoints) / timeStep;
+            }
+        }
 
         // stop, when maximum points movement is below threshold
-        if ((points - stopCriterionBuffer).square().rowwise().sum().sqrt().maxCoeff() <
-            constants::pointsMovementThreshold * initialPointDistance) {
-            break;
+        double const movementThreshold = options.pointsMovementThreshold * initialPointDistance;
+        if ((points - workspace.previousPoints).square().rowwise().sum().sqrt().maxCoeff() <
+            movementThreshold) {
+            if ((options.integrator == Integrator::euler) ||
+                (options.integrator == Integrator::adaptive)) {
+                break;
+            }
+
+            // the movement of the integrators with inertia also vanishes, when the velocity
+            // reverses its direction, so the forces must be small as well, which is checked
+            // by the movement of a plain euler step including the projection to the boundary,
+            // reusing the force buffer, which is recalculated in the next step anyway
+            workspace.nodeForce = workspace.previousPoints + options.deltaT * workspace.nodeForce;
+            utils::projectPointsToBoundary(distanceFunction, initialPointDistance,
+                workspace.nodeForce, workspace, options);
+            if ((workspace.nodeForce - workspace.previousPoints).square().rowwise().sum().sqrt()
+                .maxCoeff() < movementThreshold) {
+                break;
+            }
         }
     }
 
     return std::make_tuple(points, triangulation);
 }
+
+// apply the distmesh algorithm on successively finer levels
+std::tuple<Eigen::ArrayXXd, Eigen::ArrayXXi> distmesh::multilevel(
+    Functional const& distanceFunction, double const initialPointDistance,
+    Functional const& elementSizeFunction, Eigen::Ref<Eigen::ArrayXXd const> const boundingBox,
+    Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints, Options const& options,
+    unsigned const levels, unsigned const levelSteps) {
+    if (levels == 0) {
+        throw std::invalid_argument("distmesh::multilevel: at least one level is required");
+    }
+
+    // mesh coarsest level with the complete algorithm
+    double pointDistance = initialPointDistance * std::pow(2.0, levels - 1);
+    Eigen::ArrayXXd points;
+    Eigen::ArrayXXi triangulation;
+    std::tie(points, triangulation) = distmesh(distanceFunction, pointDistance,
+        elementSizeFunction, boundingBox, fixedPoints, options);
+
+    // finer levels start close to equilibrium and are only relaxed for a few steps
+    Options levelOptions = options;
+    levelOptions.maxSteps = std::min(options.maxSteps, levelSteps);
+
+    for (unsigned level = 1; level < levels; ++level) {
+        pointDistance /= 2.0;
+
+        // refine mesh by inserting the midpoints of all edges, keeping fixed points first
+        Eigen::ArrayXXi const edgeIndices = utils::findUniqueEdges(triangulation);
+        Eigen::ArrayXXd refinedPoints(points.rows() + edgeIndices.rows(), points.cols());
+        refinedPoints << points,
+            0.5 * (utils::selectIndexedArrayElements<double>(points, edgeIndices.col(0)) +
+                utils::selectIndexedArrayElements<double>(points, edgeIndices.col(1)));
+
+        std::tie(points, triangulation) = relax(distanceFunction, pointDistance,
+            elementSizeFunction, refinedPoints, fixedPoints.rows(), levelOptions);
+    }
+
+    return std::make_tuple(points, triangulation);
+}
@@ -0,0 +1,835 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <map>
+
+#include "distmesh/distmesh.h"
+
+namespace {
+    using distmesh::graph::Node;
+    using distmesh::graph::Operation;
+
+    // append binary representation of value to key
+    template <
+        class type
+    >
+    void append(std::string& key, type const& value) {
+        key.append(reinterpret_cast<char const*>(&value), sizeof(value));
+    }
+
+    std::string key(Node const& node) {
+        std::string key;
+        append(key, node.operation);
+        for (auto const& operand : node.operands) {
+            append(key, operand.get());
+        }
+        append(key, node.value);
+        append(key, node.parameters.rows());
+        key.append(reinterpret_cast<char const*>(node.parameters.data()),
+            node.parameters.rows() * sizeof(double));
+        key.append(node.name);
+
+        return key;
+    }
+
+    double apply(Operation const operation, double const lhs, double const rhs=0.0) {
+        switch (operation) {
+        case Operation::negate: return -lhs;
+        case Operation::absolute: return std::abs(lhs);
+        case Operation::add: return lhs + rhs;
+        case Operation::subtract: return lhs - rhs;
+        case Operation::multiply: return lhs * rhs;
+        case Operation::divide: return lhs / rhs;
+        case Operation::minimum: return std::min(lhs, rhs);
+        case Operation::maximum: return std::max(lhs, rhs);
+        default: return 0.0;
+        }
+    }
+
+    bool isConstant(std::shared_ptr<Node const> const& node, double const value) {
+        return (node->operation == Operation::constant) && (node->value == value);
+    }
+
+    bool isIdentity(double const angle, Eigen::Ref<Eigen::ArrayXd const> const offset) {
+        return (angle == 0.0) && (offset == 0.0).all();
+    }
+
+    // compose transforms, such that the result applies outer first and inner second,
+    // fails for offsets of different dimension
+    bool compose(double const innerAngle, Eigen::Ref<Eigen::ArrayXd const> const innerOffset,
+        double const outerAngle, Eigen::Ref<Eigen::ArrayXd const> const outerOffset,
+        double& angle, Eigen::ArrayXd& offset) {
+        if (((innerOffset.rows() != 0) && (outerOffset.rows() != 0) &&
+            (innerOffset.rows() != outerOffset.rows())) ||
+            ((innerAngle != 0.0) && (outerOffset.rows() == 1))) {
+            return false;
+        }
+
+        // inner(outer(x)) = R(inner) * (R(outer) * x - outerOffset) - innerOffset
+        angle = innerAngle + outerAngle;
+        offset = outerOffset;
+        if ((innerAngle != 0.0) && (offset.rows() != 0)) {
+            double const x = offset(0), y = offset(1);
+            offset(0) = x * std::cos(innerAngle) + y * std::sin(innerAngle);
+            offset(1) = -x * std::sin(innerAngle) + y * std::cos(innerAngle);
+        }
+        if (offset.rows() == 0) {
+            offset = innerOffset;
+        }
+        else if (innerOffset.rows() != 0) {
+            offset += innerOffset;
+        }
+
+        return true;
+    }
+
+    // apply transform R(angle) * x - offset to points
+    void transformPoints(double const angle, Eigen::Ref<Eigen::ArrayXd const> const offset,
+        Eigen::Ref<Eigen::ArrayXXd const> const input, Eigen::Ref<Eigen::ArrayXXd> output) {
+        if (angle != 0.0) {
+            double const cosine = std::cos(angle), sine = std::sin(angle);
+            output.col(0) = input.col(0) * cosine + input.col(1) * sine;
+            output.col(1) = -input.col(0) * sine + input.col(1) * cosine;
+            output.rightCols(output.cols() - 2) = input.rightCols(input.cols() - 2);
+        }
+        else {
+            output = input;
+        }
+
+        for (int dim = 0; dim < std::min<int>(offset.rows(), output.cols()); ++dim) {
+            output.col(dim) -= offset(dim);
+        }
+    }
+
+    // upper bound of the slope of expression, memoised for shared nodes
+    double slopeBound(Node const& node, std::map<Node const*, double>& bounds) {
+        auto const bound = bounds.find(&node);
+        if (bound != bounds.end()) {
+            return bound->second;
+        }
+
+        double result = INFINITY;
+        switch (node.operation) {
+        case Operation::constant:
+            result = 0.0;
+            break;
+
+        case Operation::primitive:
+            result = node.slopeBound;
+            break;
+
+        // negation, absolute value and rigid transforms keep the slope
+        case Operation::negate:
+        case Operation::absolute:
+        case Operation::transform:
+            result = slopeBound(*node.operands[0], bounds);
+            break;
+
+        case Operation::add:
+        case Operation::subtract:
+            result = slopeBound(*node.operands[0], bounds) + slopeBound(*node.operands[1], bounds);
+            break;
+
+        case Operation::minimum:
+        case Operation::maximum:
+            result = std::max(slopeBound(*node.operands[0], bounds),
+                slopeBound(*node.operands[1], bounds));
+            break;
+
+        // products and quotients are only bounded for constant factors
+        case Operation::multiply:
+            for (int operand = 0; operand < 2; ++operand) {
+                if (node.operands[operand]->operation == Operation::constant) {
+                    result = node.operands[operand]->value == 0.0 ? 0.0 :
+                        std::abs(node.operands[operand]->value) *
+                        slopeBound(*node.operands[1 - operand], bounds);
+                    break;
+                }
+            }
+            break;
+
+        case Operation::divide:
+            if ((node.operands[1]->operation == Operation::constant) &&
+                (node.operands[1]->value != 0.0)) {
+                result = slopeBound(*node.operands[0], bounds) / std::abs(node.operands[1]->value);
+            }
+            break;
+        }
+
+        bounds[&node] = result;
+        return result;
+    }
+
+    // memory of the registers used by Program::run, which each thread keeps between
+    // evaluations and only enlarges, when a larger block is evaluated
+    struct Registers {
+        Eigen::ArrayXd values;
+        Eigen::ArrayXd gradients;
+        Eigen::ArrayXd points;
+        Eigen::ArrayXd shiftedPoints;
+        Eigen::ArrayXd shiftedValues;
+    };
+
+    // registers of the calling thread for the time of one evaluation, evaluations
+    // nested by user defined functions, which evaluate other functionals themselves,
+    // use the next registers of the thread's stack
+    class RegisterLease {
+    public:
+        RegisterLease() {
+            if (depth_ == stack_.size()) {
+                stack_.emplace_back(new Registers());
+            }
+            this->registers_ = stack_[depth_++].get();
+        }
+        ~RegisterLease() { --depth_; }
+
+        Registers& operator*() const { return *this->registers_; }
+
+    private:
+        Registers* registers_;
+
+        static thread_local std::vector<std::unique_ptr<Registers>> stack_;
+        static thread_local unsigned depth_;
+    };
+
+    thread_local std::vector<std::unique_ptr<Registers>> RegisterLease::stack_;
+    thread_local unsigned RegisterLease::depth_ = 0;
+
+    // view the memory as array of given size, enlarging it if needed
+    Eigen::Map<Eigen::ArrayXXd> reserve(Eigen::ArrayXd& memory, int const rows, int const cols) {
+        if (memory.rows() < rows * cols) {
+            memory.resize(rows * cols);
+        }
+        return Eigen::Map<Eigen::ArrayXXd>(memory.data(), rows, cols);
+    }
+}
+
+namespace distmesh {
+namespace graph {
+    // optimises an expression graph and lowers it to the instructions of a program
+    class Compiler {
+    public:
+        explicit Compiler(Program& program) : program_(program) {}
+
+        // fold constants, merge transforms and push them down to the primitives,
+        // and map structurally identical subexpressions to a single node
+        std::shared_ptr<Node const> simplify(Node const& node);
+
+        // emit instructions evaluating node at given point register,
+        // returns index of instruction, which computes the value
+        int lower(Node const& node, int const points);
+
+        // assign value registers to all instructions, reusing registers
+        // of values, which are not needed anymore
+        void allocateRegisters();
+
+    private:
+        std::shared_ptr<Node const> intern(std::shared_ptr<Node const> const& node,
+            std::string const& key);
+        std::shared_ptr<Node const> intern(std::shared_ptr<Node const> const& node) {
+            return this->intern(node, ::key(*node));
+        }
+        std::shared_ptr<Node const> simplifyUnary(Operation const operation,
+            std::shared_ptr<Node const> const& operand);
+        std::shared_ptr<Node const> simplifyBinary(Operation const operation,
+            std::shared_ptr<Node const> const& lhs, std::shared_ptr<Node const> const& rhs);
+        std::shared_ptr<Node const> applyTransform(std::shared_ptr<Node const> const& node,
+            double const angle, Eigen::Ref<Eigen::ArrayXd const> const offset);
+        int lowerPoints(Node const& node, int const points);
+        int emit(Program::Instruction const& instruction);
+
+        Program& program_;
+        std::map<std::string, std::shared_ptr<Node const>> uniqueNodes_;
+        std::map<Node const*, std::shared_ptr<Node const>> simplifiedNodes_;
+        std::map<std::pair<Node const*, std::string>, std::shared_ptr<Node const>> transformedNodes_;
+        std::map<std::pair<Node const*, int>, int> values_;
+        std::map<std::pair<Node const*, int>, int> pointRegisters_;
+    };
+}
+}
+
+// map structurally identical nodes to a single node
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::Compiler::intern(
+    std::shared_ptr<Node const> const& node, std::string const& key) {
+    auto const unique = this->uniqueNodes_.insert(std::make_pair(key, node));
+    return unique.first->second;
+}
+
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::Compiler::simplify(
+    Node const& node) {
+    auto const simplified = this->simplifiedNodes_.find(&node);
+    if (simplified != this->simplifiedNodes_.end()) {
+        return simplified->second;
+    }
+
+    std::shared_ptr<Node const> result;
+    switch (node.operation) {
+    case Operation::constant:
+        result = this->intern(constant(node.value));
+        break;
+
+    case Operation::primitive: {
+        // unnamed primitives are only identical to themselves
+        auto const copy = primitive(node.name, node.parameters, node.evaluator,
+            node.gradientEvaluator, node.slopeBound);
+        std::string key = ::key(*copy);
+        if (node.name.empty()) {
+            append(key, &node);
+        }
+        result = this->intern(copy, key);
+        break;
+    }
+
+    case Operation::negate:
+    case Operation::absolute:
+        result = this->simplifyUnary(node.operation, this->simplify(*node.operands[0]));
+        break;
+
+    case Operation::transform:
+        result = this->applyTransform(this->simplify(*node.operands[0]),
+            node.value, node.parameters);
+        break;
+
+    default:
+        result = this->simplifyBinary(node.operation, this->simplify(*node.operands[0]),
+            this->simplify(*node.operands[1]));
+        break;
+    }
+
+    this->simplifiedNodes_[&node] = result;
+    return result;
+}
+
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::Compiler::simplifyUnary(
+    Operation const operation, std::shared_ptr<Node const> const& operand) {
+    if (operand->operation == Operation::constant) {
+        return this->intern(constant(apply(operation, operand->value)));
+    }
+    // -(-x) = x
+    else if ((operation == Operation::negate) && (operand->operation == Operation::negate)) {
+        return operand->operands[0];
+    }
+    // |-x| = |x|, ||x|| = |x|
+    else if ((operation == Operation::absolute) && ((operand->operation == Operation::negate) ||
+        (operand->operation == Operation::absolute))) {
+        return this->simplifyUnary(operation, operand->operands[0]);
+    }
+
+    return this->intern(unary(operation, operand));
+}
+
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::Compiler::simplifyBinary(
+    Operation const operation, std::shared_ptr<Node const> const& lhs,
+    std::shared_ptr<Node const> const& rhs) {
+    if ((lhs->operation == Operation::constant) && (rhs->operation == Operation::constant)) {
+        return this->intern(constant(apply(operation, lhs->value, rhs->value)));
+    }
+
+    // neutral elements and idempotent operations
+    switch (operation) {
+    case Operation::add:
+        if (isConstant(lhs, 0.0)) return rhs;
+        if (isConstant(rhs, 0.0)) return lhs;
+        break;
+
+    case Operation::subtract:
+        if (isConstant(lhs, 0.0)) return this->simplifyUnary(Operation::negate, rhs);
+        if (isConstant(rhs, 0.0)) return lhs;
+        break;
+
+    case Operation::multiply:
+        if (isConstant(lhs, 1.0)) return rhs;
+        if (isConstant(rhs, 1.0)) return lhs;
+        break;
+
+    case Operation::divide:
+        if (isConstant(rhs, 1.0)) return lhs;
+        break;
+
+    case Operation::minimum:
+    case Operation::maximum:
+        if (lhs == rhs) return lhs;
+        break;
+
+    default:
+        break;
+    }
+
+    return this->intern(binary(operation, lhs, rhs));
+}
+
+// push transform down to the primitives, merging it with existing transforms
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::Compiler::applyTransform(
+    std::shared_ptr<Node const> const& node, double const angle,
+    Eigen::Ref<Eigen::ArrayXd const> const offset) {
+    if (isIdentity(angle, offset) || (node->operation == Operation::constant)) {
+        return node;
+    }
+
+    std::string transformKey;
+    append(transformKey, angle);
+    transformKey.append(reinterpret_cast<char const*>(offset.data()), offset.rows() * sizeof(double));
+    auto const transformed = this->transformedNodes_.find(std::make_pair(node.get(), transformKey));
+    if (transformed != this->transformedNodes_.end()) {
+        return transformed->second;
+    }
+
+    std::shared_ptr<Node const> result;
+    switch (node->operation) {
+    case Operation::primitive:
+        result = this->intern(transform(node, angle, offset));
+        break;
+
+    case Operation::negate:
+    case Operation::absolute:
+        result = this->simplifyUnary(node->operation,
+            this->applyTransform(node->operands[0], angle, offset));
+        break;
+
+    case Operation::transform: {
+        double composedAngle = 0.0;
+        Eigen::ArrayXd composedOffset;
+        if (compose(node->value, node->parameters, angle, offset, composedAngle, composedOffset)) {
+            result = this->applyTransform(node->operands[0], composedAngle, composedOffset);
+        }
+        else {
+            result = this->intern(transform(node, angle, offset));
+        }
+        break;
+    }
+
+    default:
+        result = this->simplifyBinary(node->operation,
+            this->applyTransform(node->operands[0], angle, offset),
+            this->applyTransform(node->operands[1], angle, offset));
+        break;
+    }
+
+    this->transformedNodes_[std::make_pair(node.get(), transformKey)] = result;
+    return result;
+}
+
+int distmesh::graph::Compiler::emit(Program::Instruction const& instruction) {
+    this->program_.instructions_.push_back(instruction);
+    return this->program_.instructions_.size() - 1;
+}
+
+int distmesh::graph::Compiler::lower(Node const& node, int const points) {
+    auto const lowered = this->values_.find(std::make_pair(&node, points));
+    if (lowered != this->values_.end()) {
+        return lowered->second;
+    }
+
+    Program::Instruction instruction = { node.operation, -1, -1, -1, points, node.value, -1 };
+    int result = -1;
+    switch (node.operation) {
+    case Operation::constant:
+        result = this->emit(instruction);
+        break;
+
+    case Operation::primitive:
+        instruction.index = this->program_.evaluators_.size();
+        this->program_.evaluators_.push_back(node.evaluator);
+        this->program_.gradientEvaluators_.push_back(node.gradientEvaluator);
+        result = this->emit(instruction);
+        break;
+
+    case Operation::transform:
+        result = this->lower(*node.operands[0], this->lowerPoints(node, points));
+        break;
+
+    case Operation::negate:
+    case Operation::absolute:
+        instruction.lhs = this->lower(*node.operands[0], points);
+        result = this->emit(instruction);
+        break;
+
+    default:
+        instruction.lhs = this->lower(*node.operands[0], points);
+        instruction.rhs = this->lower(*node.operands[1], points);
+        result = this->emit(instruction);
+        break;
+    }
+
+    this->values_[std::make_pair(&node, points)] = result;
+    return result;
+}
+
+// emit instruction transforming points and return the new point register
+int distmesh::graph::Compiler::lowerPoints(Node const& node, int const points) {
+    auto const lowered = this->pointRegisters_.find(std::make_pair(&node, points));
+    if (lowered != this->pointRegisters_.end()) {
+        return lowered->second;
+    }
+
+    Program::Instruction instruction = { Operation::transform,
+        static_cast<int>(this->program_.pointRegisterCount_++), -1, -1, points, 0.0,
+        static_cast<int>(this->program_.transforms_.size()) };
+    this->program_.transforms_.push_back(Program::Transform{ node.value, node.parameters });
+    this->program_.pointParents_.push_back(points);
+    this->program_.pointTransforms_.push_back(instruction.index);
+    this->emit(instruction);
+
+    this->pointRegisters_[std::make_pair(&node, points)] = instruction.result;
+    return instruction.result;
+}
+
+void distmesh::graph::Compiler::allocateRegisters() {
+    auto& instructions = this->program_.instructions_;
+
+    // find last instruction using each value, the result is used until the end
+    std::vector<int> lastUse(instructions.size(), -1);
+    for (int index = 0; index < static_cast<int>(instructions.size()); ++index) {
+        if (instructions[index].lhs >= 0) {
+            lastUse[instructions[index].lhs] = index;
+        }
+        if (instructions[index].rhs >= 0) {
+            lastUse[instructions[index].rhs] = index;
+        }
+    }
+    lastUse[this->program_.result_] = instructions.size();
+
+    // release registers of operands after their last use before allocating the
+    // result register, which is safe, since all operations are element wise
+    std::vector<int> registers(instructions.size(), -1);
+    std::vector<int> freeRegisters;
+    for (int index = 0; index < static_cast<int>(instructions.size()); ++index) {
+        auto& instruction = instructions[index];
+        if (instruction.operation == Operation::transform) {
+            continue;
+        }
+
+        int const lhs = instruction.lhs, rhs = instruction.rhs;
+        if (lhs >= 0) {
+            instruction.lhs = registers[lhs];
+            if (lastUse[lhs] == index) {
+                freeRegisters.push_back(registers[lhs]);
+            }
+        }
+        if (rhs >= 0) {
+            instruction.rhs = registers[rhs];
+            if ((lastUse[rhs] == index) && (rhs != lhs)) {
+                freeRegisters.push_back(registers[rhs]);
+            }
+        }
+
+        if (freeRegisters.empty()) {
+            registers[index] = this->program_.valueRegisterCount_++;
+        }
+        else {
+            registers[index] = freeRegisters.back();
+            freeRegisters.pop_back();
+        }
+        instruction.result = registers[index];
+    }
+
+    this->program_.result_ = registers[this->program_.result_];
+}
+
+// creation of graph nodes
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::constant(double const value) {
+    auto node = std::make_shared<Node>(Operation::constant);
+    node->value = value;
+    return node;
+}
+
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::primitive(std::string const& name,
+    Eigen::Ref<Eigen::ArrayXd const> const parameters, evaluator_t const& evaluator,
+    gradient_evaluator_t const& gradientEvaluator, double const slopeBound) {
+    auto node = std::make_shared<Node>(Operation::primitive);
+    node->name = name;
+    node->parameters = parameters;
+    node->evaluator = evaluator;
+    node->gradientEvaluator = gradientEvaluator;
+    node->slopeBound = slopeBound;
+    return node;
+}
+
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::unary(Operation const operation,
+    std::shared_ptr<Node const> const& operand) {
+    auto node = std::make_shared<Node>(operation);
+    node->operands.push_back(operand);
+    return node;
+}
+
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::binary(Operation const operation,
+    std::shared_ptr<Node const> const& lhs, std::shared_ptr<Node const> const& rhs) {
+    auto node = std::make_shared<Node>(operation);
+    node->operands.push_back(lhs);
+    node->operands.push_back(rhs);
+    return node;
+}
+
+std::shared_ptr<distmesh::graph::Node const> distmesh::graph::transform(
+    std::shared_ptr<Node const> const& operand, double const angle,
+    Eigen::Ref<Eigen::ArrayXd const> const offset) {
+    auto node = std::make_shared<Node>(Operation::transform);
+    node->operands.push_back(operand);
+    node->value = angle;
+    node->parameters = offset;
+    return node;
+}
+
+// upper bound of the slope of expression
+double distmesh::graph::slopeBound(Node const& root) {
+    std::map<Node const*, double> bounds;
+    return ::slopeBound(root, bounds);
+}
+
+// evaluate expression given by its root node, compiling it on first use
+void distmesh::graph::evaluate(Node const& root, Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXd> result, unsigned const blockSize, bool const parallel) {
+    std::call_once(root.compileFlag, [&root]() {
+        root.program.reset(new Program(root));
+    });
+
+    root.program->evaluate(points, result, blockSize, parallel);
+}
+
+// evaluate expression and its gradient
+void distmesh::graph::evaluate(Node const& root, Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient,
+    double const step, unsigned const blockSize, bool const parallel) {
+    std::call_once(root.compileFlag, [&root]() {
+        root.program.reset(new Program(root));
+    });
+
+    root.program->evaluate(points, result, gradient, step, blockSize, parallel);
+}
+
+distmesh::graph::Program::Program(Node const& root) :
+    pointParents_(1, -1), pointTransforms_(1, -1), valueRegisterCount_(0),
+    pointRegisterCount_(1), result_(-1) {
+    Compiler compiler(*this);
+    this->result_ = compiler.lower(*compiler.simplify(root), 0);
+    compiler.allocateRegisters();
+}
+
+// evaluate program for all points in blocks of blockSize points
+void distmesh::graph::Program::evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXd> result, unsigned const blockSize, bool const parallel) const {
+    Eigen::ArrayXXd gradient;
+    this->run(points, result, gradient, false, 0.0, blockSize, parallel);
+}
+
+// evaluate program and its gradient
+void distmesh::graph::Program::evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient,
+    double const step, unsigned const blockSize, bool const parallel) const {
+    this->run(points, result, gradient, true, step, blockSize, parallel);
+}
+
+void distmesh::graph::Program::run(Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient,
+    bool const withGradient, double const step, unsigned blockSize, bool const parallel) const {
+    if ((blockSize == 0) || (blockSize > points.rows())) {
+        blockSize = std::max<unsigned>(points.rows(), 1);
+    }
+    int const blockCount = (points.rows() + blockSize - 1) / blockSize;
+    int const dimension = points.cols();
+
+    #pragma omp parallel if (parallel && (blockCount > 1))
+    {
+        // each thread uses its own registers for values and transformed points of a
+        // single block, point register 0 refers to the block of the input points,
+        // the gradient of value register r is stored in columns r * dimension ...
+        RegisterLease const lease;
+        auto values = reserve((*lease).values, blockSize, this->valueRegisterCount_);
+        auto gradients = reserve((*lease).gradients, withGradient ? blockSize : 0,
+            withGradient ? this->valueRegisterCount_ * dimension : 0);
+        auto pointRegisters = reserve((*lease).points, blockSize * dimension,
+            this->pointRegisterCount_ - 1);
+        auto const transformedPoints = [&](int const reg) {
+            return Eigen::Map<Eigen::ArrayXXd>(pointRegisters.col(reg - 1).data(),
+                blockSize, dimension);
+        };
+
+        // buffers for finite differences of primitives without analytic gradient
+        auto shiftedPointsBuffer = reserve((*lease).shiftedPoints, withGradient ? blockSize : 0,
+            dimension);
+        auto shiftedValuesBuffer = reserve((*lease).shiftedValues, withGradient ? blockSize : 0, 1);
+
+        #pragma omp for schedule(dynamic)
+        for (int block = 0; block < blockCount; ++block) {
+            int const start = block * blockSize;
+            int const rows = std::min<int>(blockSize, points.rows() - start);
+
+            for (auto const& instruction : this->instructions_) {
+                // transforms write to point registers
+                if (instruction.operation == Operation::transform) {
+                    auto const& transform = this->transforms_[instruction.index];
+                    if (instruction.points == 0) {
+                        transformPoints(transform.angle, transform.offset,
+                            points.middleRows(start, rows),
+                            transformedPoints(instruction.result).topRows(rows));
+                    }
+                    else {
+                        transformPoints(transform.angle, transform.offset,
+                            transformedPoints(instruction.points).topRows(rows),
+                            transformedPoints(instruction.result).topRows(rows));
+                    }
+                    continue;
+                }
+
+                auto output = values.col(instruction.result).head(rows);
+                auto const lhs = values.col(std::max(instruction.lhs, 0)).head(rows);
+                auto const rhs = values.col(std::max(instruction.rhs, 0)).head(rows);
+
+                // gradient is calculated first, since the result register might be
+                // identical to one of the operand registers
+                if (withGradient) {
+                    auto outputGradient = gradients.block(0, instruction.result * dimension,
+                        rows, dimension);
+                    auto const lhsGradient = gradients.block(0, std::max(instruction.lhs, 0) * dimension,
+                        rows, dimension);
+                    auto const rhsGradient = gradients.block(0, std::max(instruction.rhs, 0) * dimension,
+                        rows, dimension);
+
+                    switch (instruction.operation) {
+                    case Operation::constant:
+                        outputGradient.setZero();
+                        break;
+
+                    case Operation::primitive: {
+                        Eigen::Ref<Eigen::ArrayXXd const> const primitivePoints =
+                            instruction.points == 0 ?
+                            Eigen::Ref<Eigen::ArrayXXd const>(points.middleRows(start, rows)) :
+                            Eigen::Ref<Eigen::ArrayXXd const>(
+                                transformedPoints(instruction.points).topRows(rows));
+
+                        if (this->gradientEvaluators_[instruction.index]) {
+                            this->gradientEvaluators_[instruction.index](primitivePoints,
+                                output, outputGradient);
+                        }
+                        else {
+                            this->evaluators_[instruction.index](primitivePoints, output);
+
+                            auto shiftedPoints = shiftedPointsBuffer.topRows(rows);
+                            auto shiftedValues = shiftedValuesBuffer.col(0).head(rows);
+                            shiftedPoints = primitivePoints;
+                            for (int dim = 0; dim < dimension; ++dim) {
+                                shiftedPoints.col(dim) += step;
+                                this->evaluators_[instruction.index](shiftedPoints, shiftedValues);
+                                outputGradient.col(dim) = (shiftedValues - output) / step;
+                                shiftedPoints.col(dim) = primitivePoints.col(dim);
+                            }
+                        }
+
+                        // transform gradient back to the coordinates of the input points,
+                        // the transposed rotation undoes the rotation of the points
+                        for (int reg = instruction.points; reg != 0; reg = this->pointParents_[reg]) {
+                            double const angle = this->transforms_[this->pointTransforms_[reg]].angle;
+                            if (angle != 0.0) {
+                                double const cosine = std::cos(angle), sine = std::sin(angle);
+                                for (int row = 0; row < rows; ++row) {
+                                    double const x = outputGradient(row, 0);
+                                    double const y = outputGradient(row, 1);
+                                    outputGradient(row, 0) = x * cosine - y * sine;
+                                    outputGradient(row, 1) = x * sine + y * cosine;
+                                }
+                            }
+                        }
+
+                        // value is already evaluated
+                        continue;
+                    }
+
+                    case Operation::negate:
+                        outputGradient = -lhsGradient;
+                        break;
+
+                    case Operation::absolute:
+                        for (int dim = 0; dim < dimension; ++dim) {
+                            outputGradient.col(dim) = (lhs < 0.0).select(-lhsGradient.col(dim),
+                                lhsGradient.col(dim));
+                        }
+                        break;
+
+                    case Operation::add:
+                        outputGradient = lhsGradient + rhsGradient;
+                        break;
+
+                    case Operation::subtract:
+                        outputGradient = lhsGradient - rhsGradient;
+                        break;
+
+                    case Operation::multiply:
+                        outputGradient = lhsGradient.colwise() * rhs + rhsGradient.colwise() * lhs;
+                        break;
+
+                    case Operation::divide:
+                        outputGradient = (lhsGradient.colwise() * rhs - rhsGradient.colwise() * lhs)
+                            .colwise() / rhs.square();
+                        break;
+
+                    case Operation::minimum:
+                        for (int dim = 0; dim < dimension; ++dim) {
+                            outputGradient.col(dim) = (lhs <= rhs).select(lhsGradient.col(dim),
+                                rhsGradient.col(dim));
+                        }
+                        break;
+
+                    case Operation::maximum:
+                        for (int dim = 0; dim < dimension; ++dim) {
+                            outputGradient.col(dim) = (lhs >= rhs).select(lhsGradient.col(dim),
+                                rhsGradient.col(dim));
+                        }
+                        break;
+
+                    default:
+                        break;
+                    }
+                }
+
+                switch (instruction.operation) {
+                case Operation::constant:
+                    output.setConstant(instruction.value);
+                    break;
+
+                case Operation::primitive:
+                    if (instruction.points == 0) {
+                        this->evaluators_[instruction.index](points.middleRows(start, rows), output);
+                    }
+                    else {
+                        this->evaluators_[instruction.index](
+                            transformedPoints(instruction.points).topRows(rows), output);
+                    }
+                    break;
+
+                case Operation::negate: output = -lhs; break;
+                case Operation::absolute: output = lhs.abs(); break;
+                case Operation::add: output = lhs + rhs; break;
+                case Operation::subtract: output = lhs - rhs; break;
+                case Operation::multiply: output = lhs * rhs; break;
+                case Operation::divide: output = lhs / rhs; break;
+                case Operation::minimum: output = lhs.min(rhs); break;
+                case Operation::maximum: output = lhs.max(rhs); break;
+                default: break;
+                }
+            }
+
+            result.segment(start, rows) = values.col(this->result_).head(rows);
+            if (withGradient) {
+                gradient.middleRows(start, rows) = gradients.block(0, this->result_ * dimension,
+                    rows, dimension);
+            }
+        }
+    }
+}
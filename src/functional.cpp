@@ -19,226 +19,224 @@
 // --------------------------------------------------------------------
 
 #include "distmesh/distmesh.h"
+#include "distmesh/constants.h"
+
+distmesh::EvaluationPolicy::EvaluationPolicy() :
+    blockSize(0), parallel(false) {}
+
+distmesh::EvaluationPolicy::EvaluationPolicy(unsigned const blockSize, bool const parallel) :
+    blockSize(blockSize), parallel(parallel) {}
+
+distmesh::EvaluationPolicy distmesh::EvaluationPolicy::blocked(bool const parallel) {
+    return EvaluationPolicy(constants::evaluationBlockSize, parallel);
+}
+
+// create class from function type as unnamed primitive
+distmesh::Functional::Functional(function_t const& func) :
+    node_(graph::primitive("", Eigen::ArrayXd(), [func](
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> result) {
+        result = func(points);
+    })) {}
+
+distmesh::Functional::Functional(double const constant) :
+    node_(graph::constant(constant)) {}
+
+// create class from primitive function
+distmesh::Functional distmesh::Functional::primitive(std::string const& name,
+    Eigen::Ref<Eigen::ArrayXd const> const parameters, graph::evaluator_t const& evaluator,
+    graph::gradient_evaluator_t const& gradientEvaluator, double const slopeBound) {
+    return Functional(graph::primitive(name, parameters, evaluator, gradientEvaluator, slopeBound));
+}
 
 // assignment operator
 distmesh::Functional& distmesh::Functional::operator=(
     Functional const& rhs) {
-    this->function() = rhs.function();
+    this->node_ = rhs.node_;
+    this->function_ = std::atomic_load(&rhs.function_);
     return *this;
 }
 distmesh::Functional& distmesh::Functional::operator=(
     Functional&& rhs) {
-    this->function() = std::move(rhs.function());
+    this->node_ = std::move(rhs.node_);
+    this->function_ = std::move(rhs.function_);
     return *this;
 }
 
 Eigen::ArrayXd distmesh::Functional::operator()(
     Eigen::Ref<Eigen::ArrayXXd const> const points) const {
-    return this->function()(points);
+    return (*this)(points, EvaluationPolicy());
+}
+
+Eigen::ArrayXd distmesh::Functional::operator()(
+    Eigen::Ref<Eigen::ArrayXXd const> const points, EvaluationPolicy const& policy) const {
+    Eigen::ArrayXd result(points.rows());
+    this->evaluate(points, result, policy);
+
+    return result;
+}
+
+// evaluate function and store values in result
+void distmesh::Functional::evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXd> result, EvaluationPolicy const& policy) const {
+    graph::evaluate(*this->node_, points, result, policy.blockSize, policy.parallel);
+}
+
+// evaluate function and its gradient
+void distmesh::Functional::evaluate(Eigen::Ref<Eigen::ArrayXXd const> const points,
+    Eigen::Ref<Eigen::ArrayXd> result, Eigen::Ref<Eigen::ArrayXXd> gradient, double const step,
+    EvaluationPolicy const& policy) const {
+    graph::evaluate(*this->node_, points, result, gradient, step, policy.blockSize, policy.parallel);
+}
+
+// upper bound of the slope of the function
+double distmesh::Functional::slopeBound() const {
+    return graph::slopeBound(*this->node_);
 }
 
 distmesh::Functional distmesh::Functional::operator-() const {
-    auto const func = this->function();;
-    return DISTMESH_FUNCTIONAL({
-        return -func(points);
-    });
+    return Functional(graph::unary(graph::Operation::negate, this->node_));
 }
 
 distmesh::Functional& distmesh::Functional::operator+=(
     Functional const& rhs) {
-    auto const func = this->function();
-    this->function() = DISTMESH_FUNCTIONAL({
-        return func(points) + rhs(points);
-    });
-    return *this;
+    return *this = *this + rhs;
 }
 
 distmesh::Functional& distmesh::Functional::operator+=(
     double const rhs) {
-    auto const func = this->function();
-    this->function() = DISTMESH_FUNCTIONAL({
-        return func(points) + rhs;
-    });
-    return *this;
+    return *this = *this + rhs;
 }
 
 distmesh::Functional& distmesh::Functional::operator-=(
     Functional const& rhs) {
-    auto const func = this->function();
-    this->function() = DISTMESH_FUNCTIONAL({
-        return func(points) - rhs(points);
-    });
-    return *this;
+    return *this = *this - rhs;
 }
 
 distmesh::Functional& distmesh::Functional::operator-=(
     double const rhs) {
-    auto const func = this->function();
-    this->function() = DISTMESH_FUNCTIONAL({
-        return func(points) - rhs;
-    });
-    return *this;
+    return *this = *this - rhs;
 }
 
 distmesh::Functional& distmesh::Functional::operator*=(
     Functional const& rhs) {
-    auto const func = this->function();
-    this->function() = DISTMESH_FUNCTIONAL({
-        return func(points) * rhs(points);
-    });
-    return *this;
+    return *this = *this * rhs;
 }
 
 distmesh::Functional& distmesh::Functional::operator*=(
     double const rhs) {
-    auto const func = this->function();
-    this->function() = DISTMESH_FUNCTIONAL({
-        return func(points) * rhs;
-    });
-    return *this;
+    return *this = *this * rhs;
 }
 
 distmesh::Functional& distmesh::Functional::operator/=(
     Functional const& rhs) {
-    auto const func = this->function();
-    this->function() = DISTMESH_FUNCTIONAL({
-        return func(points) / rhs(points);
-    });
-    return *this;
+    return *this = *this / rhs;
 }
 
 distmesh::Functional& distmesh::Functional::operator/=(
     double const rhs) {
-    auto const func = this->function();
-    this->function() = DISTMESH_FUNCTIONAL({
-        return func(points) / rhs;
-    });
-    return *this;
+    return *this = *this / rhs;
 }
 
 distmesh::Functional distmesh::operator+(
     Functional const& lhs, Functional const& rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs(points) + rhs(points);
-    });
+    return Functional(graph::binary(graph::Operation::add, lhs.node_, rhs.node_));
 }
 
 distmesh::Functional distmesh::operator+(
     Functional const& lhs, double const rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs(points) + rhs;
-    });
+    return lhs + Functional(rhs);
 }
 
 distmesh::Functional distmesh::operator+(
     double const lhs, Functional const& rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs + rhs(points);
-    });
+    return Functional(lhs) + rhs;
 }
 
 distmesh::Functional distmesh::operator-(
     Functional const& lhs, Functional const& rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs(points) - rhs(points);
-    });
+    return Functional(graph::binary(graph::Operation::subtract, lhs.node_, rhs.node_));
 }
 
 distmesh::Functional distmesh::operator-(
     Functional const& lhs, double const rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs(points) - rhs;
-    });
+    return lhs - Functional(rhs);
 }
 
 distmesh::Functional distmesh::operator-(
     double const lhs, Functional const& rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs - rhs(points);
-    });
+    return Functional(lhs) - rhs;
 }
 
 distmesh::Functional distmesh::operator*(
     Functional const& lhs, Functional const& rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs(points) * rhs(points);
-    });
+    return Functional(graph::binary(graph::Operation::multiply, lhs.node_, rhs.node_));
 }
 
 distmesh::Functional distmesh::operator*(
     Functional const& lhs, double const rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs(points) * rhs;
-    });
+    return lhs * Functional(rhs);
 }
 
 distmesh::Functional distmesh::operator*(
     double const lhs, Functional const& rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs * rhs(points);
-    });
+    return Functional(lhs) * rhs;
 }
 
 distmesh::Functional distmesh::operator/(
     Functional const& lhs, Functional const& rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs(points) / rhs(points);
-    });
+    return Functional(graph::binary(graph::Operation::divide, lhs.node_, rhs.node_));
 }
 
 distmesh::Functional distmesh::operator/(
     Functional const& lhs, double const rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs(points) / rhs;
-    });
+    return lhs / Functional(rhs);
 }
 
 distmesh::Functional distmesh::operator/(
     double const lhs, Functional const& rhs) {
-    return DISTMESH_FUNCTIONAL({
-        return lhs / rhs(points);
-    });
+    return Functional(lhs) / rhs;
 }
 
 distmesh::Functional distmesh::Functional::min(
     Functional const& rhs) const {
-    auto const func = this->function();
-    return DISTMESH_FUNCTIONAL({
-        return func(points).min(rhs(points));
-    });
+    return Functional(graph::binary(graph::Operation::minimum, this->node_, rhs.node_));
 }
 
 distmesh::Functional distmesh::Functional::max(
     Functional const& rhs) const {
-    auto const func = this->function();
-    return DISTMESH_FUNCTIONAL({
-        return func(points).max(rhs(points));
-    });
+    return Functional(graph::binary(graph::Operation::maximum, this->node_, rhs.node_));
 }
 
 distmesh::Functional distmesh::Functional::abs() const {
-    auto const func = this->function();
-    return DISTMESH_FUNCTIONAL({
-        return func(points).abs();
-    });
+    return Functional(graph::unary(graph::Operation::absolute, this->node_));
 }
 
 // geometric transform
 distmesh::Functional distmesh::Functional::shift(Eigen::Ref<Eigen::ArrayXd const> const offset) const {
-    auto const func = this->function();
-    return DISTMESH_FUNCTIONAL({
-        return func(points.rowwise() - offset.transpose());
-    });
+    return Functional(graph::transform(this->node_, 0.0, offset));
 }
 
 distmesh::Functional distmesh::Functional::rotate2D(double const angle) const {
-    auto const func = this->function();
-    return DISTMESH_FUNCTIONAL({
-        Eigen::ArrayXXd transformedPoints(points.rows(), points.cols());
-        transformedPoints.col(0) = points.col(0) * std::cos(angle) + points.col(1) * std::sin(angle);
-        transformedPoints.col(1) = -points.col(0) * std::sin(angle) + points.col(1) * std::cos(angle);
-
-        return func(transformedPoints);
-    });
+    return Functional(graph::transform(this->node_, angle, Eigen::ArrayXd()));
 }
 
+// function object evaluating the expression, which is shared by all copies
+// of the functional and only created once, even for concurrent calls
+distmesh::Functional::function_t const& distmesh::Functional::function() const {
+    auto function = std::atomic_load(&this->function_);
+    if (!function) {
+        auto const node = this->node_;
+        auto const created = std::make_shared<function_t const>(
+            [node](Eigen::Ref<Eigen::ArrayXXd const> const points) -> Eigen::ArrayXd {
+                return Functional(node)(points);
+            });
+
+        // keep the function object of a concurrent call, if it was stored first
+        if (std::atomic_compare_exchange_strong(&this->function_, &function,
+            std::shared_ptr<function_t const>(created))) {
+            function = created;
+        }
+    }
+
+    return *function;
+}
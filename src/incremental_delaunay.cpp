@@ -0,0 +1,599 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "distmesh/distmesh.h"
+#include "distmesh/triangulation.h"
+#include "distmesh/predicates.h"
+
+namespace {
+    // index of point on hilbert curve through a 2^16 x 2^16 grid
+    uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+        uint32_t const n = 1u << 16;
+        uint64_t index = 0;
+        for (uint32_t s = n / 2; s > 0; s /= 2) {
+            uint32_t const rx = (x & s) > 0;
+            uint32_t const ry = (y & s) > 0;
+            index += (uint64_t)s * s * ((3 * rx) ^ ry);
+
+            // rotate quadrant
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+
+        return index;
+    }
+
+    // rotation of the enclosing triangle corners against the coordinate axes
+    double const enclosingTriangleRotation = 0.3;
+}
+
+Eigen::ArrayXXi distmesh::triangulation::IncrementalDelaunay::delaunay(
+    Eigen::Ref<Eigen::ArrayXXd const> const points) {
+    if (!this->repair(points)) {
+        this->rebuild(points);
+    }
+
+    return this->triangles();
+}
+
+void distmesh::triangulation::IncrementalDelaunay::rebuild(
+    Eigen::Ref<Eigen::ArrayXXd const> const points) {
+    this->pointCount_ = points.rows();
+    this->skippedPoints_ = 0;
+    this->vertices_.clear();
+    this->neighbours_.clear();
+    this->freeTriangles_.clear();
+    this->coordinates_.resize(2 * (points.rows() + 3));
+    this->vertexTriangles_.assign(points.rows() + 3, -1);
+
+    // enclose all points in an auxiliary triangle with vertices infinitely far away
+    Eigen::ArrayXd lower = Eigen::ArrayXd::Zero(2);
+    Eigen::ArrayXd upper = Eigen::ArrayXd::Zero(2);
+    if (points.rows() > 0) {
+        lower = points.colwise().minCoeff().transpose();
+        upper = points.colwise().maxCoeff().transpose();
+    }
+    this->center_[0] = 0.5 * (lower(0) + upper(0));
+    this->center_[1] = 0.5 * (lower(1) + upper(1));
+
+    for (int point = 0; point < points.rows(); ++point) {
+        this->coordinates_[2 * point] = points(point, 0);
+        this->coordinates_[2 * point + 1] = points(point, 1);
+    }
+
+    // the directions of the corners are rotated away from the coordinate axes,
+    // so straight boundaries of typical domains are not parallel to them
+    for (int corner = 0; corner < 3; ++corner) {
+        double const angle = enclosingTriangleRotation + corner * 2.0 * M_PI / 3.0;
+        this->coordinates_[2 * (points.rows() + corner)] = std::cos(angle);
+        this->coordinates_[2 * (points.rows() + corner) + 1] = std::sin(angle);
+    }
+
+    this->vertices_.reserve(3 * (2 * points.rows() + 1));
+    this->neighbours_.reserve(3 * (2 * points.rows() + 1));
+    this->setTriangle(this->allocateTriangle(), points.rows(), points.rows() + 1,
+        points.rows() + 2, -1, -1, -1);
+
+    // sort points along hilbert curve, so consecutive points are close
+    // to each other and the point location walk stays short
+    std::vector<std::pair<uint64_t, int>> insertionOrder(points.rows());
+    Eigen::ArrayXd const scale = 65535.0 / (upper - lower).max(1e-300);
+    for (int point = 0; point < points.rows(); ++point) {
+        insertionOrder[point] = std::make_pair(hilbertIndex(
+            (uint32_t)((points(point, 0) - lower(0)) * scale(0)),
+            (uint32_t)((points(point, 1) - lower(1)) * scale(1))), point);
+    }
+    std::sort(insertionOrder.begin(), insertionOrder.end());
+
+    // insert all points
+    int triangle = 0;
+    for (auto const& point : insertionOrder) {
+        if (!this->insert(point.second, triangle)) {
+            this->skippedPoints_++;
+        }
+    }
+}
+
+bool distmesh::triangulation::IncrementalDelaunay::repair(
+    Eigen::Ref<Eigen::ArrayXXd const> const points) {
+    // repair is only possible for an existing triangulation containing all points
+    if ((points.rows() != this->pointCount_) || (points.cols() != 2) ||
+        (this->skippedPoints_ != 0) || this->vertices_.empty()) {
+        return false;
+    }
+
+    // update points positions, but keep the previous ones for relocation
+    this->previousCoordinates_ = this->coordinates_;
+    for (int point = 0; point < points.rows(); ++point) {
+        this->coordinates_[2 * point] = points(point, 0);
+        this->coordinates_[2 * point + 1] = points(point, 1);
+    }
+
+    // find inverted triangles, typically slivers at the convex hull
+    int const triangleCount = this->vertices_.size() / 3;
+    std::vector<int> invertedTriangles;
+    for (int triangle = 0; triangle < triangleCount; ++triangle) {
+        if (this->isInverted(triangle)) {
+            invertedTriangles.push_back(triangle);
+        }
+    }
+
+    // move vertices of inverted triangles by removing and reinserting them
+    if (!invertedTriangles.empty() && !this->relocate(invertedTriangles, points)) {
+        return false;
+    }
+
+    // check all edges once and flip the ones violating the delaunay property
+    this->flipStack_.clear();
+    for (int triangle = 0; triangle < (int)this->vertices_.size() / 3; ++triangle)
+    for (int index = 0; index < 3; ++index) {
+        if (this->neighbours_[3 * triangle + index] > triangle) {
+            this->flipStack_.push_back(std::make_pair(triangle, index));
+        }
+    }
+    this->legalize();
+
+    return true;
+}
+
+Eigen::ArrayXXi distmesh::triangulation::IncrementalDelaunay::triangles() const {
+    // skip unused triangles and triangles connected to the enclosing triangle
+    auto const isPointTriangle = [=](int const triangle) {
+        return (this->vertices_[3 * triangle] >= 0) &&
+            (this->vertices_[3 * triangle] < this->pointCount_) &&
+            (this->vertices_[3 * triangle + 1] < this->pointCount_) &&
+            (this->vertices_[3 * triangle + 2] < this->pointCount_);
+    };
+
+    int const triangleCount = this->vertices_.size() / 3;
+    int count = 0;
+    for (int triangle = 0; triangle < triangleCount; ++triangle) {
+        count += isPointTriangle(triangle);
+    }
+
+    Eigen::ArrayXXi result(count, 3);
+    count = 0;
+    for (int triangle = 0; triangle < triangleCount; ++triangle) {
+        if (isPointTriangle(triangle)) {
+            result.row(count) << this->vertices_[3 * triangle],
+                this->vertices_[3 * triangle + 1], this->vertices_[3 * triangle + 2];
+            count++;
+        }
+    }
+
+    return result;
+}
+
+int distmesh::triangulation::IncrementalDelaunay::allocateTriangle() {
+    if (!this->freeTriangles_.empty()) {
+        int const triangle = this->freeTriangles_.back();
+        this->freeTriangles_.pop_back();
+        return triangle;
+    }
+
+    this->vertices_.resize(this->vertices_.size() + 3, -1);
+    this->neighbours_.resize(this->neighbours_.size() + 3, -1);
+    return this->vertices_.size() / 3 - 1;
+}
+
+void distmesh::triangulation::IncrementalDelaunay::setTriangle(int const triangle,
+    int const v0, int const v1, int const v2, int const n0, int const n1, int const n2) {
+    this->vertices_[3 * triangle] = v0;
+    this->vertices_[3 * triangle + 1] = v1;
+    this->vertices_[3 * triangle + 2] = v2;
+    this->neighbours_[3 * triangle] = n0;
+    this->neighbours_[3 * triangle + 1] = n1;
+    this->neighbours_[3 * triangle + 2] = n2;
+    this->vertexTriangles_[v0] = triangle;
+    this->vertexTriangles_[v1] = triangle;
+    this->vertexTriangles_[v2] = triangle;
+}
+
+void distmesh::triangulation::IncrementalDelaunay::replaceNeighbour(int const triangle,
+    int const oldNeighbour, int const newNeighbour) {
+    if (triangle < 0) {
+        return;
+    }
+    for (int index = 0; index < 3; ++index) {
+        if (this->neighbours_[3 * triangle + index] == oldNeighbour) {
+            this->neighbours_[3 * triangle + index] = newNeighbour;
+            return;
+        }
+    }
+}
+
+int distmesh::triangulation::IncrementalDelaunay::neighbourIndex(int const triangle,
+    int const neighbour) {
+    int index = 0;
+    while (this->triangleNeighbour(triangle, index) != neighbour) {
+        index++;
+    }
+    return index;
+}
+
+bool distmesh::triangulation::IncrementalDelaunay::isInverted(int const triangle) const {
+    return (this->vertices_[3 * triangle] >= 0) &&
+        (this->orientation(this->vertices_[3 * triangle], this->vertices_[3 * triangle + 1],
+            this->vertices_[3 * triangle + 2]) <= 0.0);
+}
+
+double distmesh::triangulation::IncrementalDelaunay::orientation(int const v0, int const v1,
+    int const v2) const {
+    int const enclosingCount = this->isEnclosing(v0) + this->isEnclosing(v1) +
+        this->isEnclosing(v2);
+    if (enclosingCount == 0) {
+        return predicates::orient2d(this->vertex(v0), this->vertex(v1), this->vertex(v2));
+    }
+    else if (enclosingCount == 1) {
+        // rotate vertices, so the enclosing vertex is the last one, whose side is
+        // given by its direction, or by its finite offset, if the direction is parallel
+        int const a = this->isEnclosing(v2) ? v0 : this->isEnclosing(v0) ? v1 : v2;
+        int const b = this->isEnclosing(v2) ? v1 : this->isEnclosing(v0) ? v2 : v0;
+        int const c = this->isEnclosing(v2) ? v2 : this->isEnclosing(v0) ? v0 : v1;
+
+        double const orientation = predicates::orient2dDirection(this->vertex(a),
+            this->vertex(b), this->vertex(c));
+        return orientation != 0.0 ? orientation :
+            predicates::orient2d(this->vertex(a), this->vertex(b), this->center_);
+    }
+
+    // the order of two consecutive enclosing vertices alone determines the orientation,
+    // since their directions are in counterclockwise order
+    int const a = !this->isEnclosing(v0) ? v1 : !this->isEnclosing(v1) ? v2 : v0;
+    int const b = !this->isEnclosing(v0) ? v2 : !this->isEnclosing(v1) ? v0 : v1;
+    return (b - this->pointCount_) == (a - this->pointCount_ + 1) % 3 ? 1.0 : -1.0;
+}
+
+double distmesh::triangulation::IncrementalDelaunay::inCircle(int const v0, int const v1,
+    int const v2, int const v3) const {
+    int const enclosingCount = this->isEnclosing(v0) + this->isEnclosing(v1) +
+        this->isEnclosing(v2);
+
+    // rotate the counterclockwise vertices of the triangle, so all enclosing ones are last
+    int a = v0, b = v1, c = v2;
+    while ((enclosingCount > 0) && (enclosingCount < 3) &&
+        (!this->isEnclosing(c) || ((enclosingCount == 2) && !this->isEnclosing(b)))) {
+        int const rotated = a;
+        a = b;
+        b = c;
+        c = rotated;
+    }
+
+    if (enclosingCount == 0) {
+        // points infinitely far away are outside of every finite circle
+        return this->isEnclosing(v3) ? -1.0 : predicates::incircle(this->vertex(a),
+            this->vertex(b), this->vertex(c), this->vertex(v3));
+    }
+    else if (enclosingCount == 1) {
+        // the circle degenerates to the half plane left of the edge a-b, including
+        // the edge itself, for another enclosing vertex it depends on which direction
+        // points further to the left
+        if (this->isEnclosing(v3)) {
+            double const direction[2] = {
+                this->vertex(v3)[0] - this->vertex(c)[0],
+                this->vertex(v3)[1] - this->vertex(c)[1] };
+            return predicates::orient2dDirection(this->vertex(a), this->vertex(b), direction);
+        }
+
+        double const orientation = predicates::orient2d(this->vertex(a), this->vertex(b),
+            this->vertex(v3));
+        if (orientation != 0.0) {
+            return orientation;
+        }
+
+        double const* const pa = this->vertex(a);
+        double const* const pb = this->vertex(b);
+        double const* const pd = this->vertex(v3);
+        return ((pd[0] - pa[0]) * (pb[0] - pa[0]) + (pd[1] - pa[1]) * (pb[1] - pa[1]) > 0.0) &&
+            ((pd[0] - pb[0]) * (pa[0] - pb[0]) + (pd[1] - pb[1]) * (pa[1] - pb[1]) > 0.0) ?
+            1.0 : -1.0;
+    }
+    else if (enclosingCount == 2) {
+        // the circle degenerates to the half plane through a, which is facing away
+        // from the direction of the third enclosing vertex, the third vertex itself
+        // is always outside
+        if (this->isEnclosing(v3)) {
+            return -1.0;
+        }
+
+        int const third = 3 * this->pointCount_ + 3 - b - c;
+        double const normal[2] = { -this->vertex(third)[1], this->vertex(third)[0] };
+        return -predicates::orient2dDirection(this->vertex(a), this->vertex(v3), normal);
+    }
+
+    // every point lies inside the enclosing triangle
+    return 1.0;
+}
+
+int distmesh::triangulation::IncrementalDelaunay::locate(int const vertex, int triangle) {
+    // visibility walk starting with a random edge in each triangle, which terminates
+    // in any valid triangulation, not only in delaunay triangulations
+    for (;;) {
+        this->randomState_ ^= this->randomState_ << 13;
+        this->randomState_ ^= this->randomState_ >> 17;
+        this->randomState_ ^= this->randomState_ << 5;
+
+        int next = -1;
+        for (int i = 0; i < 3; ++i) {
+            int const index = (i + this->randomState_) % 3;
+            if (this->orientation(this->triangleVertex(triangle, index + 1),
+                this->triangleVertex(triangle, index + 2), vertex) < 0.0) {
+                next = this->triangleNeighbour(triangle, index);
+
+                // the enclosing triangle contains all finite points, so this
+                // only happens for invalid coordinates
+                if (next < 0) {
+                    throw std::runtime_error(
+                        "distmesh::triangulation::IncrementalDelaunay::locate: point outside of triangulation");
+                }
+                break;
+            }
+        }
+        if (next < 0) {
+            return triangle;
+        }
+        triangle = next;
+    }
+}
+
+bool distmesh::triangulation::IncrementalDelaunay::insert(int const vertex, int& triangle) {
+    triangle = this->locate(vertex, triangle);
+
+    // find location of point relative to triangle edges
+    int zeroCount = 0, zeroIndex = 0;
+    for (int index = 0; index < 3; ++index) {
+        if (this->orientation(this->triangleVertex(triangle, index + 1),
+            this->triangleVertex(triangle, index + 2), vertex) == 0.0) {
+            zeroCount++;
+            zeroIndex = index;
+        }
+    }
+
+    // point coincides with existing vertex
+    if (zeroCount > 1) {
+        return false;
+    }
+
+    int const a = this->triangleVertex(triangle, zeroIndex);
+    int const b = this->triangleVertex(triangle, zeroIndex + 1);
+    int const c = this->triangleVertex(triangle, zeroIndex + 2);
+    int const na = this->triangleNeighbour(triangle, zeroIndex);
+    int const nb = this->triangleNeighbour(triangle, zeroIndex + 1);
+    int const nc = this->triangleNeighbour(triangle, zeroIndex + 2);
+
+    this->flipStack_.clear();
+    if (zeroCount == 0) {
+        // split triangle into three
+        int const t0 = triangle;
+        int const t1 = this->allocateTriangle();
+        int const t2 = this->allocateTriangle();
+
+        this->setTriangle(t0, vertex, b, c, na, t1, t2);
+        this->setTriangle(t1, vertex, c, a, nb, t2, t0);
+        this->setTriangle(t2, vertex, a, b, nc, t0, t1);
+        this->replaceNeighbour(nb, triangle, t1);
+        this->replaceNeighbour(nc, triangle, t2);
+
+        this->flipStack_.push_back(std::make_pair(t0, 0));
+        this->flipStack_.push_back(std::make_pair(t1, 0));
+        this->flipStack_.push_back(std::make_pair(t2, 0));
+    }
+    else {
+        // point lies on edge b-c, split both adjacent triangles into two
+        int const u = na;
+        int const opposite = this->neighbourIndex(u, triangle);
+        int const d = this->triangleVertex(u, opposite);
+        int const nbd = this->triangleNeighbour(u, opposite + 1);
+        int const ndc = this->triangleNeighbour(u, opposite + 2);
+
+        int const tA = triangle;
+        int const uA = u;
+        int const tB = this->allocateTriangle();
+        int const uB = this->allocateTriangle();
+
+        this->setTriangle(tA, a, b, vertex, uB, tB, nc);
+        this->setTriangle(tB, a, vertex, c, uA, nb, tA);
+        this->setTriangle(uA, d, c, vertex, tB, uB, ndc);
+        this->setTriangle(uB, d, vertex, b, tA, nbd, uA);
+        this->replaceNeighbour(nb, triangle, tB);
+        this->replaceNeighbour(nbd, u, uB);
+
+        this->flipStack_.push_back(std::make_pair(tA, 2));
+        this->flipStack_.push_back(std::make_pair(tB, 1));
+        this->flipStack_.push_back(std::make_pair(uA, 2));
+        this->flipStack_.push_back(std::make_pair(uB, 1));
+    }
+
+    this->legalize();
+    return true;
+}
+
+int distmesh::triangulation::IncrementalDelaunay::remove(int const vertex) {
+    for (;;) {
+        // collect triangles around vertex in counterclockwise order
+        std::vector<std::pair<int, int>> star;
+        int triangle = this->vertexTriangles_[vertex];
+        do {
+            int index = 0;
+            while (this->triangleVertex(triangle, index) != vertex) {
+                index++;
+            }
+            star.push_back(std::make_pair(triangle, index));
+            triangle = this->triangleNeighbour(triangle, index + 1);
+        } while (triangle != star.front().first);
+
+        // merge remaining three triangles into one
+        if (star.size() == 3) {
+            int outer[3], link[3];
+            for (int i = 0; i < 3; ++i) {
+                link[i] = this->triangleVertex(star[i].first, star[i].second + 1);
+                outer[i] = this->triangleNeighbour(star[i].first, star[i].second);
+            }
+
+            int const merged = star[0].first;
+            this->setTriangle(merged, link[0], link[1], link[2], outer[1], outer[2], outer[0]);
+            this->replaceNeighbour(outer[1], star[1].first, merged);
+            this->replaceNeighbour(outer[2], star[2].first, merged);
+            for (int i = 1; i < 3; ++i) {
+                std::fill(&this->vertices_[3 * star[i].first], &this->vertices_[3 * star[i].first + 3], -1);
+                std::fill(&this->neighbours_[3 * star[i].first], &this->neighbours_[3 * star[i].first + 3], -1);
+                this->freeTriangles_.push_back(star[i].first);
+            }
+            this->vertexTriangles_[vertex] = -1;
+
+            return merged;
+        }
+
+        // reduce degree of vertex by flipping one of its edges,
+        // which is always possible for a star shaped neighbourhood
+        bool flipped = false;
+        for (auto const& element : star) {
+            if (this->isFlippable(element.first, element.second + 2)) {
+                this->flip(element.first, element.second + 2);
+                flipped = true;
+                break;
+            }
+        }
+        if (!flipped) {
+            return -1;
+        }
+    }
+}
+
+bool distmesh::triangulation::IncrementalDelaunay::relocate(
+    std::vector<int> invertedTriangles, Eigen::Ref<Eigen::ArrayXXd const> const points) {
+    // reset all vertices of inverted triangles to their previous positions,
+    // until the triangulation is valid again
+    std::vector<int> relocatedVertices;
+    std::vector<bool> isRelocated(this->pointCount_, false);
+    while (!invertedTriangles.empty()) {
+        auto const relocatedCount = relocatedVertices.size();
+        for (auto const triangle : invertedTriangles)
+        for (int index = 0; index < 3; ++index) {
+            int const vertex = this->triangleVertex(triangle, index);
+            if ((vertex < this->pointCount_) && !isRelocated[vertex]) {
+                isRelocated[vertex] = true;
+                relocatedVertices.push_back(vertex);
+                this->coordinates_[2 * vertex] = this->previousCoordinates_[2 * vertex];
+                this->coordinates_[2 * vertex + 1] = this->previousCoordinates_[2 * vertex + 1];
+            }
+        }
+
+        // all previous positions form a valid triangulation, so this should never happen
+        if (relocatedVertices.size() == relocatedCount) {
+            return false;
+        }
+
+        invertedTriangles.clear();
+        for (int triangle = 0; triangle < (int)this->vertices_.size() / 3; ++triangle) {
+            if (this->isInverted(triangle)) {
+                invertedTriangles.push_back(triangle);
+            }
+        }
+    }
+
+    // move each vertex to its new position
+    this->flipStack_.clear();
+    for (auto const vertex : relocatedVertices) {
+        int triangle = this->remove(vertex);
+        if (triangle < 0) {
+            return false;
+        }
+
+        this->coordinates_[2 * vertex] = points(vertex, 0);
+        this->coordinates_[2 * vertex + 1] = points(vertex, 1);
+        if (!this->insert(vertex, triangle)) {
+            this->skippedPoints_++;
+        }
+    }
+
+    return true;
+}
+
+void distmesh::triangulation::IncrementalDelaunay::flip(int const triangle, int const index) {
+    // triangle (a, b, c) and neighbour (d, c, b) become (a, b, d) and (a, d, c)
+    int const u = this->triangleNeighbour(triangle, index);
+    int const opposite = this->neighbourIndex(u, triangle);
+
+    int const a = this->triangleVertex(triangle, index);
+    int const b = this->triangleVertex(triangle, index + 1);
+    int const c = this->triangleVertex(triangle, index + 2);
+    int const d = this->triangleVertex(u, opposite);
+    int const nca = this->triangleNeighbour(triangle, index + 1);
+    int const nab = this->triangleNeighbour(triangle, index + 2);
+    int const nbd = this->triangleNeighbour(u, opposite + 1);
+    int const ndc = this->triangleNeighbour(u, opposite + 2);
+
+    this->setTriangle(triangle, a, b, d, nbd, u, nab);
+    this->setTriangle(u, a, d, c, ndc, nca, triangle);
+    this->replaceNeighbour(nbd, u, triangle);
+    this->replaceNeighbour(nca, triangle, u);
+
+    // queue outer edges of the flipped quadrilateral
+    this->flipStack_.push_back(std::make_pair(triangle, 0));
+    this->flipStack_.push_back(std::make_pair(triangle, 2));
+    this->flipStack_.push_back(std::make_pair(u, 0));
+    this->flipStack_.push_back(std::make_pair(u, 1));
+}
+
+bool distmesh::triangulation::IncrementalDelaunay::isFlippable(int const triangle,
+    int const index) {
+    int const u = this->triangleNeighbour(triangle, index);
+    if (u < 0) {
+        return false;
+    }
+
+    // both resulting triangles (a, b, d) and (a, d, c) must be valid
+    int const a = this->triangleVertex(triangle, index);
+    int const b = this->triangleVertex(triangle, index + 1);
+    int const c = this->triangleVertex(triangle, index + 2);
+    int const d = this->triangleVertex(u, this->neighbourIndex(u, triangle));
+    return (this->orientation(a, b, d) > 0.0) && (this->orientation(a, d, c) > 0.0);
+}
+
+void distmesh::triangulation::IncrementalDelaunay::legalize() {
+    while (!this->flipStack_.empty()) {
+        int const triangle = this->flipStack_.back().first;
+        int const index = this->flipStack_.back().second;
+        this->flipStack_.pop_back();
+
+        int const u = this->triangleNeighbour(triangle, index);
+        if (u < 0) {
+            continue;
+        }
+
+        // flip edge, if the opposite vertex of the neighbour lies inside the circumcircle
+        if (this->inCircle(this->triangleVertex(triangle, 0), this->triangleVertex(triangle, 1),
+            this->triangleVertex(triangle, 2),
+            this->triangleVertex(u, this->neighbourIndex(u, triangle))) > 0.0) {
+            this->flip(triangle, index);
+        }
+    }
+}
@@ -0,0 +1,255 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "distmesh/distmesh.h"
+#include "distmesh/predicates.h"
+
+namespace {
+    // all tests are evaluated exactly for the query points moved by an infinitesimal
+    // amount in positive x direction and an even smaller one in positive y direction,
+    // which resolves all degenerate cases consistently with the crossing number test
+
+    // side of moved point x relative to the line through segment from a to b
+    int segmentSide(double const* const a, double const* const b, double const* const x) {
+        double const orientation = distmesh::predicates::orient2d(a, b, x);
+        if (orientation != 0.0) {
+            return orientation > 0.0 ? 1 : -1;
+        }
+        else if (b[1] != a[1]) {
+            return b[1] < a[1] ? 1 : -1;
+        }
+        else {
+            return b[0] > a[0] ? 1 : -1;
+        }
+    }
+
+    // side of vertex v relative to the line through the moved points c and p
+    int querySide(double const* const c, double const* const p, double const* const v) {
+        double const orientation = distmesh::predicates::orient2d(c, p, v);
+        if (orientation != 0.0) {
+            return orientation > 0.0 ? 1 : -1;
+        }
+        else if (p[1] != c[1]) {
+            return p[1] > c[1] ? 1 : -1;
+        }
+        else {
+            return p[0] < c[0] ? 1 : -1;
+        }
+    }
+
+    // whether the ray from moved point x in positive x direction crosses segment from a to b
+    bool crossesRay(double const* const a, double const* const b, double const* const x) {
+        if ((x[1] < a[1]) == (x[1] < b[1])) {
+            return false;
+        }
+
+        return b[1] > a[1] ? segmentSide(a, b, x) > 0 : segmentSide(a, b, x) < 0;
+    }
+
+    // cell index along one axis, clamped to the grid
+    int cellIndex(double const position, double const origin, double const cellSize,
+        int const count) {
+        return std::min(std::max(static_cast<int>(std::floor((position - origin) / cellSize)), 0),
+            count - 1);
+    }
+}
+
+// create grid for closed rings
+distmesh::geometry::InsideGrid::InsideGrid(std::vector<Eigen::ArrayXXd> const& rings) :
+    origin_{ 0.0, 0.0 }, end_{ 0.0, 0.0 }, cellSize_{ 1.0, 1.0 }, columns_(1), rows_(1) {
+    for (auto const& ring : rings) {
+        if (ring.cols() != 2) {
+            throw std::invalid_argument(
+                "distmesh::geometry::InsideGrid::InsideGrid: rings must be 2d polygons");
+        }
+
+        for (int i = 0, j = ring.rows() - 1; i < ring.rows(); j = i++) {
+            this->segments_.push_back(Segment{ { ring(j, 0), ring(j, 1) },
+                { ring(i, 0), ring(i, 1) } });
+        }
+    }
+
+    // bounding box of all rings, points outside of it are outside of the rings
+    double magnitude = 0.0;
+    if (!this->segments_.empty()) {
+        for (int dim = 0; dim < 2; ++dim) {
+            this->origin_[dim] = INFINITY;
+            this->end_[dim] = -INFINITY;
+            for (auto const& segment : this->segments_) {
+                this->origin_[dim] = std::min(this->origin_[dim], segment.b[dim]);
+                this->end_[dim] = std::max(this->end_[dim], segment.b[dim]);
+            }
+            magnitude = std::max(magnitude, std::max(std::abs(this->origin_[dim]),
+                std::abs(this->end_[dim])));
+        }
+    }
+
+    // about one cell per segment with cells as square as possible
+    double const width = this->end_[0] - this->origin_[0];
+    double const height = this->end_[1] - this->origin_[1];
+    if ((width > 0.0) && (height > 0.0)) {
+        double const segmentCount = this->segments_.size();
+        this->columns_ = std::min(std::max(static_cast<int>(std::round(
+            std::sqrt(segmentCount * width / height))), 1), static_cast<int>(segmentCount));
+        this->rows_ = std::min(std::max(static_cast<int>(std::round(
+            std::sqrt(segmentCount * height / width))), 1), static_cast<int>(segmentCount));
+        this->cellSize_[0] = width / this->columns_;
+        this->cellSize_[1] = height / this->rows_;
+    }
+
+    // find all cells touched by each segment, enlarged by a small padding to
+    // account for rounding errors
+    std::vector<int> cells, cellSegments;
+    double padding[2];
+    for (int dim = 0; dim < 2; ++dim) {
+        padding[dim] = 1e-6 * this->cellSize_[dim] +
+            16.0 * std::numeric_limits<double>::epsilon() * magnitude;
+    }
+    for (int segment = 0; segment < static_cast<int>(this->segments_.size()); ++segment) {
+        auto const& s = this->segments_[segment];
+        double const minY = std::min(s.a[1], s.b[1]), maxY = std::max(s.a[1], s.b[1]);
+
+        int const firstRow = cellIndex(minY - padding[1], this->origin_[1], this->cellSize_[1],
+            this->rows_);
+        int const lastRow = cellIndex(maxY + padding[1], this->origin_[1], this->cellSize_[1],
+            this->rows_);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            // part of segment inside of the row
+            double minX = std::min(s.a[0], s.b[0]), maxX = std::max(s.a[0], s.b[0]);
+            if (s.a[1] != s.b[1]) {
+                double const lower = std::max(minY, this->origin_[1] + row * this->cellSize_[1] -
+                    padding[1]);
+                double const upper = std::min(maxY, this->origin_[1] + (row + 1) * this->cellSize_[1] +
+                    padding[1]);
+                double const lowerX = s.a[0] + (s.b[0] - s.a[0]) * (lower - s.a[1]) / (s.b[1] - s.a[1]);
+                double const upperX = s.a[0] + (s.b[0] - s.a[0]) * (upper - s.a[1]) / (s.b[1] - s.a[1]);
+                minX = std::max(minX, std::min(lowerX, upperX));
+                maxX = std::min(maxX, std::max(lowerX, upperX));
+            }
+
+            int const firstColumn = cellIndex(minX - padding[0], this->origin_[0],
+                this->cellSize_[0], this->columns_);
+            int const lastColumn = cellIndex(maxX + padding[0], this->origin_[0],
+                this->cellSize_[0], this->columns_);
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                cells.push_back(row * this->columns_ + column);
+                cellSegments.push_back(segment);
+            }
+        }
+    }
+    this->cellSegments_ = utils::invertIndexTable(
+        Eigen::Map<Eigen::ArrayXi const>(cells.data(), cells.size()), this->cellCount());
+    for (int n = 0; n < this->cellSegments_.indices.rows(); ++n) {
+        this->cellSegments_.indices(n) = cellSegments[this->cellSegments_.indices(n)];
+    }
+
+    // classify cell centers row by row, each segment crossing the ray from the
+    // centers of a row flips the state of all centers left of the crossing
+    this->cellInside_.assign(this->cellCount(), false);
+    std::vector<int> visited(this->segments_.size(), -1);
+    std::vector<bool> flip(this->columns_ + 1);
+    for (int row = 0; row < this->rows_; ++row) {
+        std::fill(flip.begin(), flip.end(), false);
+
+        for (int cell = row * this->columns_; cell < (row + 1) * this->columns_; ++cell)
+        for (int n = 0; n < this->cellSegments_.count(cell); ++n) {
+            int const segment = this->cellSegments_(cell, n);
+            if (visited[segment] == row) {
+                continue;
+            }
+            visited[segment] = row;
+
+            // the centers left of the crossing are found by bisection
+            auto const& s = this->segments_[segment];
+            double center[2];
+            int lower = 0, upper = this->columns_;
+            while (lower < upper) {
+                int const middle = (lower + upper) / 2;
+                this->cellCenter(middle, row, center);
+                if (crossesRay(s.a, s.b, center)) {
+                    lower = middle + 1;
+                }
+                else {
+                    upper = middle;
+                }
+            }
+            flip[0] = !flip[0];
+            flip[lower] = !flip[lower];
+        }
+
+        bool inside = false;
+        for (int column = 0; column < this->columns_; ++column) {
+            inside = inside != flip[column];
+            this->cellInside_[row * this->columns_ + column] = inside;
+        }
+    }
+}
+
+// 1.0 for points inside of the rings, 0.0 for points outside
+Eigen::ArrayXd distmesh::geometry::InsideGrid::pointsInside(
+    Eigen::Ref<Eigen::ArrayXXd const> const points) const {
+    Eigen::ArrayXd inside(points.rows());
+    for (int point = 0; point < points.rows(); ++point) {
+        double const coordinates[2] = { points(point, 0), points(point, 1) };
+        inside(point) = this->isInside(coordinates) ? 1.0 : 0.0;
+    }
+
+    return inside;
+}
+
+// center of grid cell
+void distmesh::geometry::InsideGrid::cellCenter(int const column, int const row,
+    double* const center) const {
+    center[0] = this->origin_[0] + (column + 0.5) * this->cellSize_[0];
+    center[1] = this->origin_[1] + (row + 0.5) * this->cellSize_[1];
+}
+
+// classify single point by the segments crossed on the way from its cell center
+bool distmesh::geometry::InsideGrid::isInside(double const* const point) const {
+    if ((point[0] < this->origin_[0]) || (point[0] >= this->end_[0]) ||
+        (point[1] < this->origin_[1]) || (point[1] >= this->end_[1])) {
+        return false;
+    }
+
+    int const cell = cellIndex(point[1], this->origin_[1], this->cellSize_[1], this->rows_) *
+        this->columns_ + cellIndex(point[0], this->origin_[0], this->cellSize_[0], this->columns_);
+    double center[2];
+    this->cellCenter(cell % this->columns_, cell / this->columns_, center);
+
+    bool inside = this->cellInside_[cell];
+    if ((center[0] == point[0]) && (center[1] == point[1])) {
+        return inside;
+    }
+
+    for (int n = 0; n < this->cellSegments_.count(cell); ++n) {
+        auto const& s = this->segments_[this->cellSegments_(cell, n)];
+        if ((segmentSide(s.a, s.b, center) != segmentSide(s.a, s.b, point)) &&
+            (querySide(center, point, s.a) != querySide(center, point, s.b))) {
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
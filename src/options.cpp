@@ -0,0 +1,73 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <stdexcept>
+
+#include "distmesh/distmesh.h"
+#include "distmesh/constants.h"
+
+distmesh::Options::Options() :
+    pointsMovementThreshold(constants::pointsMovementThreshold),
+    retriangulationThreshold(constants::retriangulationThreshold),
+    deltaT(constants::deltaT), deltaX(constants::deltaX), maxSteps(constants::maxSteps),
+    boundaryBandWidth(constants::boundaryBandWidth), forceAssembly(ForceAssembly::scatter),
+    integrator(Integrator::euler), initialization(Initialization::rejection), seed(constants::seed) {
+}
+
+// coarse convergence criterion and boundary band for quick previews
+distmesh::Options distmesh::Options::draft() {
+    Options options;
+    options.pointsMovementThreshold = 1e-2;
+    options.retriangulationThreshold = 2e-1;
+    options.maxSteps = 200;
+    options.boundaryBandWidth = 1.0;
+
+    return options;
+}
+
+distmesh::Options distmesh::Options::balanced() {
+    return Options();
+}
+
+// tight convergence criterion and frequent retriangulation for final meshes
+distmesh::Options distmesh::Options::production() {
+    Options options;
+    options.pointsMovementThreshold = 1e-4;
+    options.retriangulationThreshold = 5e-2;
+    options.maxSteps = 50000;
+
+    return options;
+}
+
+// get preset by its name
+distmesh::Options distmesh::Options::preset(std::string const& name) {
+    if (name == "draft") {
+        return draft();
+    }
+    else if (name == "balanced") {
+        return balanced();
+    }
+    else if (name == "production") {
+        return production();
+    }
+    else {
+        throw std::invalid_argument("distmesh::Options::preset: unknown preset: " + name);
+    }
+}
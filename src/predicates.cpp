@@ -0,0 +1,227 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "distmesh/predicates.h"
+
+namespace {
+    // half of the machine epsilon, i.e. the relative rounding error
+    double const epsilon = 0.5 * std::numeric_limits<double>::epsilon();
+
+    // error bounds of the floating point evaluation of the predicates
+    double const orientErrorBound = (3.0 + 16.0 * epsilon) * epsilon;
+    double const incircleErrorBound = (10.0 + 96.0 * epsilon) * epsilon;
+
+    // arbitrary precision number represented as sum of non overlapping
+    // doubles with increasing magnitude, zero components are eliminated
+    typedef std::vector<double> Expansion;
+
+    // exact sum a + b = x + y, with x the rounded result
+    inline void twoSum(double const a, double const b, double& x, double& y) {
+        x = a + b;
+        double const bVirtual = x - a;
+        double const aVirtual = x - bVirtual;
+        y = (a - aVirtual) + (b - bVirtual);
+    }
+
+    // exact product a * b = x + y, with x the rounded result
+    inline void twoProduct(double const a, double const b, double& x, double& y) {
+        x = a * b;
+        y = std::fma(a, b, -x);
+    }
+
+    // add a single double to expansion
+    Expansion grow(Expansion const& e, double const b) {
+        Expansion h;
+        h.reserve(e.size() + 1);
+
+        double q = b, sum = 0.0, error = 0.0;
+        for (auto const component : e) {
+            twoSum(q, component, sum, error);
+            q = sum;
+            if (error != 0.0) {
+                h.push_back(error);
+            }
+        }
+        if ((q != 0.0) || h.empty()) {
+            h.push_back(q);
+        }
+
+        return h;
+    }
+
+    // sum of two expansions
+    Expansion sum(Expansion e, Expansion const& f) {
+        for (auto const component : f) {
+            e = grow(e, component);
+        }
+        return e;
+    }
+
+    // product of expansion with a single double
+    Expansion scale(Expansion const& e, double const b) {
+        Expansion h;
+        h.reserve(2 * e.size());
+
+        double q = 0.0, error = 0.0, product = 0.0, productError = 0.0, sum = 0.0;
+        twoProduct(e[0], b, q, error);
+        if (error != 0.0) {
+            h.push_back(error);
+        }
+        for (size_t i = 1; i < e.size(); ++i) {
+            twoProduct(e[i], b, product, productError);
+            twoSum(q, productError, sum, error);
+            if (error != 0.0) {
+                h.push_back(error);
+            }
+            twoSum(product, sum, q, error);
+            if (error != 0.0) {
+                h.push_back(error);
+            }
+        }
+        if ((q != 0.0) || h.empty()) {
+            h.push_back(q);
+        }
+
+        return h;
+    }
+
+    // product of two expansions
+    Expansion product(Expansion const& e, Expansion const& f) {
+        Expansion result(1, 0.0);
+        for (auto const component : f) {
+            result = sum(result, scale(e, component));
+        }
+        return result;
+    }
+
+    // exact difference a - b as expansion
+    Expansion difference(double const a, double const b) {
+        return grow(Expansion(1, a), -b);
+    }
+
+    Expansion negate(Expansion e) {
+        for (auto& component : e) {
+            component = -component;
+        }
+        return e;
+    }
+
+    // the sign of an expansion is given by its largest component
+    double estimate(Expansion const& e) {
+        return e.back();
+    }
+
+    double orient2dExact(double const* const a, double const* const b, double const* const c) {
+        auto const acx = difference(a[0], c[0]);
+        auto const acy = difference(a[1], c[1]);
+        auto const bcx = difference(b[0], c[0]);
+        auto const bcy = difference(b[1], c[1]);
+
+        return estimate(sum(product(acx, bcy), negate(product(acy, bcx))));
+    }
+
+    double orient2dDirectionExact(double const* const a, double const* const b,
+        double const* const direction) {
+        auto const bax = difference(b[0], a[0]);
+        auto const bay = difference(b[1], a[1]);
+
+        return estimate(sum(scale(bax, direction[1]), negate(scale(bay, direction[0]))));
+    }
+
+    double incircleExact(double const* const a, double const* const b, double const* const c,
+        double const* const d) {
+        auto const adx = difference(a[0], d[0]);
+        auto const ady = difference(a[1], d[1]);
+        auto const bdx = difference(b[0], d[0]);
+        auto const bdy = difference(b[1], d[1]);
+        auto const cdx = difference(c[0], d[0]);
+        auto const cdy = difference(c[1], d[1]);
+
+        auto const aLift = sum(product(adx, adx), product(ady, ady));
+        auto const bLift = sum(product(bdx, bdx), product(bdy, bdy));
+        auto const cLift = sum(product(cdx, cdx), product(cdy, cdy));
+
+        auto const bc = sum(product(bdx, cdy), negate(product(cdx, bdy)));
+        auto const ca = sum(product(cdx, ady), negate(product(adx, cdy)));
+        auto const ab = sum(product(adx, bdy), negate(product(bdx, ady)));
+
+        return estimate(sum(sum(product(aLift, bc), product(bLift, ca)), product(cLift, ab)));
+    }
+}
+
+double distmesh::predicates::orient2d(double const* const a, double const* const b,
+    double const* const c) {
+    double const left = (a[0] - c[0]) * (b[1] - c[1]);
+    double const right = (a[1] - c[1]) * (b[0] - c[0]);
+    double const determinant = left - right;
+
+    // accept floating point result, if its sign is guaranteed by the error bound
+    if (std::abs(determinant) >= orientErrorBound * (std::abs(left) + std::abs(right))) {
+        return determinant;
+    }
+
+    return orient2dExact(a, b, c);
+}
+
+double distmesh::predicates::orient2dDirection(double const* const a,
+    double const* const b, double const* const direction) {
+    double const left = (b[0] - a[0]) * direction[1];
+    double const right = (b[1] - a[1]) * direction[0];
+    double const determinant = left - right;
+
+    // same error bound as orient2d, since the determinant is evaluated alike
+    if (std::abs(determinant) >= orientErrorBound * (std::abs(left) + std::abs(right))) {
+        return determinant;
+    }
+
+    return orient2dDirectionExact(a, b, direction);
+}
+
+double distmesh::predicates::incircle(double const* const a, double const* const b,
+    double const* const c, double const* const d) {
+    double const adx = a[0] - d[0], ady = a[1] - d[1];
+    double const bdx = b[0] - d[0], bdy = b[1] - d[1];
+    double const cdx = c[0] - d[0], cdy = c[1] - d[1];
+
+    double const bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double const cdxady = cdx * ady, adxcdy = adx * cdy;
+    double const adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    double const aLift = adx * adx + ady * ady;
+    double const bLift = bdx * bdx + bdy * bdy;
+    double const cLift = cdx * cdx + cdy * cdy;
+
+    double const determinant = aLift * (bdxcdy - cdxbdy) + bLift * (cdxady - adxcdy) +
+        cLift * (adxbdy - bdxady);
+    double const permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * aLift +
+        (std::abs(cdxady) + std::abs(adxcdy)) * bLift +
+        (std::abs(adxbdy) + std::abs(bdxady)) * cLift;
+
+    // accept floating point result, if its sign is guaranteed by the error bound
+    if (std::abs(determinant) > incircleErrorBound * permanent) {
+        return determinant;
+    }
+
+    return incircleExact(a, b, c, d);
+}
@@ -0,0 +1,173 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "distmesh/distmesh.h"
+
+namespace {
+    // maximum number of segments of a leaf of the tree
+    int const leafSize = 4;
+
+    // sufficient for the depth of a tree created by median splits
+    int const maxStackSize = 64;
+}
+
+// create tree for closed rings
+distmesh::geometry::SegmentTree::SegmentTree(std::vector<Eigen::ArrayXXd> const& rings) {
+    for (auto const& ring : rings) {
+        if (ring.cols() != 2) {
+            throw std::invalid_argument(
+                "distmesh::geometry::SegmentTree::SegmentTree: rings must be 2d polygons");
+        }
+
+        for (int i = 0, j = ring.rows() - 1; i < ring.rows(); j = i++) {
+            this->segments_.push_back(Segment{ ring(j, 0), ring(j, 1), ring(i, 0), ring(i, 1) });
+        }
+    }
+
+    if (!this->segments_.empty()) {
+        this->nodes_.reserve(2 * (this->segments_.size() / leafSize + 1));
+        this->build(0, this->segments_.size());
+    }
+}
+
+// recursively create the subtree for segments in range [begin, end)
+int distmesh::geometry::SegmentTree::build(int const begin, int const end) {
+    int const node = this->nodes_.size();
+    this->nodes_.push_back(TreeNode{ INFINITY, INFINITY, -INFINITY, -INFINITY, begin, end, -1 });
+
+    // bounding box of segments and of their midpoints
+    TreeNode box = this->nodes_[node];
+    double midMinX = INFINITY, midMinY = INFINITY, midMaxX = -INFINITY, midMaxY = -INFINITY;
+    for (int segment = begin; segment < end; ++segment) {
+        auto const& s = this->segments_[segment];
+        box.minX = std::min(box.minX, std::min(s.ax, s.bx));
+        box.minY = std::min(box.minY, std::min(s.ay, s.by));
+        box.maxX = std::max(box.maxX, std::max(s.ax, s.bx));
+        box.maxY = std::max(box.maxY, std::max(s.ay, s.by));
+
+        midMinX = std::min(midMinX, 0.5 * (s.ax + s.bx));
+        midMinY = std::min(midMinY, 0.5 * (s.ay + s.by));
+        midMaxX = std::max(midMaxX, 0.5 * (s.ax + s.bx));
+        midMaxY = std::max(midMaxY, 0.5 * (s.ay + s.by));
+    }
+    this->nodes_[node] = box;
+
+    if (end - begin <= leafSize) {
+        return node;
+    }
+
+    // split segments at median of their midpoints along the longest axis
+    int const middle = begin + (end - begin) / 2;
+    if (midMaxX - midMinX >= midMaxY - midMinY) {
+        std::nth_element(this->segments_.begin() + begin, this->segments_.begin() + middle,
+            this->segments_.begin() + end, [](Segment const& lhs, Segment const& rhs) {
+                return lhs.ax + lhs.bx < rhs.ax + rhs.bx;
+            });
+    }
+    else {
+        std::nth_element(this->segments_.begin() + begin, this->segments_.begin() + middle,
+            this->segments_.begin() + end, [](Segment const& lhs, Segment const& rhs) {
+                return lhs.ay + lhs.by < rhs.ay + rhs.by;
+            });
+    }
+
+    this->build(begin, middle);
+    int const secondChild = this->build(middle, end);
+    this->nodes_[node].secondChild = secondChild;
+
+    return node;
+}
+
+// distance of points to the closest segment and the closest points on it
+void distmesh::geometry::SegmentTree::closestPoints(
+    Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd> distance,
+    Eigen::Ref<Eigen::ArrayXXd> closest) const {
+    for (int point = 0; point < points.rows(); ++point) {
+        double squaredDistance = INFINITY;
+        this->closestPoint(points(point, 0), points(point, 1), squaredDistance,
+            closest(point, 0), closest(point, 1));
+        distance(point) = std::sqrt(squaredDistance);
+    }
+}
+
+// nearest segment of a single point by a depth first search visiting the closer child first
+void distmesh::geometry::SegmentTree::closestPoint(double const x, double const y,
+    double& squaredDistance, double& closestX, double& closestY) const {
+    auto const boxDistance = [x, y](TreeNode const& node) {
+        double const dx = std::max(std::max(node.minX - x, x - node.maxX), 0.0);
+        double const dy = std::max(std::max(node.minY - y, y - node.maxY), 0.0);
+        return dx * dx + dy * dy;
+    };
+
+    int stack[maxStackSize];
+    int stackSize = 0;
+    if (!this->nodes_.empty()) {
+        stack[stackSize++] = 0;
+    }
+
+    while (stackSize > 0) {
+        int const index = stack[--stackSize];
+        auto const& node = this->nodes_[index];
+        if (boxDistance(node) >= squaredDistance) {
+            continue;
+        }
+
+        // check all segments of leaf
+        if (node.secondChild < 0) {
+            for (int segment = node.begin; segment < node.end; ++segment) {
+                auto const& s = this->segments_[segment];
+                double const vx = s.bx - s.ax, vy = s.by - s.ay;
+                double const c1 = vx * (x - s.ax) + vy * (y - s.ay);
+                double const c2 = vx * vx + vy * vy;
+
+                // closest point on segment
+                double cx = s.bx, cy = s.by;
+                if (c1 <= 0.0) {
+                    cx = s.ax;
+                    cy = s.ay;
+                }
+                else if (c1 < c2) {
+                    cx = vx * (c1 / c2) + s.ax;
+                    cy = vy * (c1 / c2) + s.ay;
+                }
+
+                double const segmentDistance = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+                if (segmentDistance < squaredDistance) {
+                    squaredDistance = segmentDistance;
+                    closestX = cx;
+                    closestY = cy;
+                }
+            }
+            continue;
+        }
+
+        // push farther child first to visit the closer one first
+        int first = index + 1, second = node.secondChild;
+        if (boxDistance(this->nodes_[first]) > boxDistance(this->nodes_[second])) {
+            std::swap(first, second);
+        }
+        stack[stackSize++] = second;
+        stack[stackSize++] = first;
+    }
+}
@@ -19,59 +19,106 @@
 // --------------------------------------------------------------------
 
 #include <stdio.h>
+#include <stdexcept>
 
-// qhull library used to calculate delaunay triangulation
+// reentrant qhull library used to calculate delaunay triangulation
 extern "C" {
-    #define qh_QHimport
-    #include <qhull/qhull_a.h>
+    #include <libqhull_r/qhull_ra.h>
 }
 
 #include "distmesh/distmesh.h"
 #include "distmesh/triangulation.h"
 
-Eigen::ArrayXXi distmesh::triangulation::delaunay(
-    Eigen::Ref<Eigen::ArrayXXd const> const points) {
-    // reset qhull
-    if (qh_qh) {
-        qh_save_qhull();
-    }
+namespace {
+    // initializes qhull context for a single run and frees all its memory,
+    // when leaving the scope, including failed runs
+    struct QhullRun {
+        explicit QhullRun(qhT* const qh) : qh(qh) {
+            qh_zero(this->qh, stderr);
+        }
 
-    // convert points array to row major format
-    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic,
-        Eigen::RowMajor> pointsRowMajor = points;
-
-    // calculate delaunay triangulation
-    std::string flags = "qhull d Qt Qbb Qc Qz";
-    qh_new_qhull(points.cols(), points.rows(), pointsRowMajor.data(), False,
-        (char*)flags.c_str(), nullptr, stderr);
-    qh_triangulate();
-
-    // count all upper delaunay facets
-    unsigned facetCount = 0;
-    facetT* facet;
-    FORALLfacets {
-        if (!facet->upperdelaunay) {
-            facetCount++;
+        ~QhullRun() {
+            int currentLong = 0, totalLong = 0;
+            qh_freeqhull(this->qh, !qh_ALL);
+            qh_memfreeshort(this->qh, &currentLong, &totalLong);
         }
-    }
 
-    // extract point ids from delaunay triangulation
-    Eigen::ArrayXXi triangulation(facetCount, points.cols() + 1);
-    unsigned facetId = 0;
-    unsigned vertexId = 0;
-    vertexT* vertex, **vertexp;
-
-    FORALLfacets {
-        vertexId = 0;
-        if (!facet->upperdelaunay) {
-            qh_setsize(facet->vertices);
-            FOREACHvertex_(facet->vertices) {
-                triangulation(facetId, vertexId) = qh_pointid(vertex->point);
-                vertexId++;
+        qhT* const qh;
+    };
+}
+
+namespace {
+    // delaunay triangulation by qhull using the given row major point buffer
+    Eigen::ArrayXXi qhullDelaunay(Eigen::Ref<Eigen::ArrayXXd const> const points,
+        Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>& pointsRowMajor) {
+        // every run uses its own qhull context, since qh_new_qhull sets up its memory
+        // pools again anyway, qhull macros expect the context to be named qh
+        qhT context;
+        qhT* const qh = &context;
+
+        // convert points array to row major format
+        pointsRowMajor = points;
+
+        // calculate delaunay triangulation, the context is zeroed before
+        // and all its memory is freed after the run
+        QhullRun const run(qh);
+        std::string flags = "qhull d Qt Qbb Qc Qz";
+        if (qh_new_qhull(qh, points.cols(), points.rows(), pointsRowMajor.data(), False,
+            (char*)flags.c_str(), nullptr, stderr) != 0) {
+            throw std::runtime_error("distmesh::triangulation::qhull: qhull failed");
+        }
+        qh_triangulate(qh);
+
+        // count all upper delaunay facets
+        unsigned facetCount = 0;
+        facetT* facet;
+        FORALLfacets {
+            if (!facet->upperdelaunay) {
+                facetCount++;
             }
-            facetId++;
         }
+
+        // extract point ids from delaunay triangulation
+        Eigen::ArrayXXi triangulation(facetCount, points.cols() + 1);
+        unsigned facetId = 0;
+        unsigned vertexId = 0;
+        vertexT* vertex, **vertexp;
+
+        FORALLfacets {
+            vertexId = 0;
+            if (!facet->upperdelaunay) {
+                qh_setsize(qh, facet->vertices);
+                FOREACHvertex_(facet->vertices) {
+                    triangulation(facetId, vertexId) = qh_pointid(qh, vertex->point);
+                    vertexId++;
+                }
+                facetId++;
+            }
+        }
+
+        return triangulation;
     }
+}
 
-    return triangulation;
+Eigen::ArrayXXi distmesh::triangulation::Triangulator::delaunay(
+    Eigen::Ref<Eigen::ArrayXXd const> const points) {
+    // use native incremental triangulation for 2d point sets
+    if (points.cols() == 2) {
+        return this->incremental_.delaunay(points);
+    }
+
+    // reuse point buffer for qhull
+    return qhullDelaunay(points, this->pointsRowMajor_);
+}
+
+Eigen::ArrayXXi distmesh::triangulation::delaunay(
+    Eigen::Ref<Eigen::ArrayXXd const> const points) {
+    Triangulator triangulator;
+    return triangulator.delaunay(points);
+}
+
+Eigen::ArrayXXi distmesh::triangulation::qhull(
+    Eigen::Ref<Eigen::ArrayXXd const> const points) {
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> pointsRowMajor;
+    return qhullDelaunay(points, pointsRowMajor);
 }
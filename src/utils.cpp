@@ -18,9 +18,14 @@
 // Contact: patrik.gebhardt@rub.de
 // --------------------------------------------------------------------
 
-#include <set>
-#include <array>
 #include <vector>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include <stdexcept>
 
 #include "distmesh/distmesh.h"
 #include "distmesh/constants.h"
@@ -33,55 +38,508 @@ Eigen::ArrayXXd distmesh::utils::boundingBox(unsigned const dimension) {
     return box;
 }
 
+namespace {
+    // block of the initial lattice given by the range of point indices in each dimension
+    struct LatticeBlock {
+        std::vector<int64_t> begin;
+        std::vector<int64_t> end;
+
+        int64_t pointCount() const {
+            int64_t count = 1;
+            for (unsigned dim = 0; dim < this->begin.size(); ++dim) {
+                count *= this->end[dim] - this->begin[dim];
+            }
+            return count;
+        }
+
+        // append linear indices of all points of block, given the stride of each dimension
+        void appendIndices(std::vector<int64_t> const& stride, std::vector<int64_t>& indices) const {
+            std::vector<int64_t> index = this->begin;
+            while (true) {
+                int64_t linearIndex = 0;
+                for (unsigned dim = 0; dim < index.size(); ++dim) {
+                    linearIndex += index[dim] * stride[dim];
+                }
+                indices.push_back(linearIndex);
+
+                unsigned dim = 0;
+                for (; dim < index.size(); ++dim) {
+                    if (++index[dim] < this->end[dim]) {
+                        break;
+                    }
+                    index[dim] = this->begin[dim];
+                }
+                if (dim == index.size()) {
+                    return;
+                }
+            }
+        }
+    };
+
+    // hash of a row of exact point coordinates, with negative and positive zero hashed alike
+    std::size_t hashPoint(Eigen::Ref<Eigen::ArrayXXd const> const points, int const point) {
+        std::size_t hash = 0;
+        for (int dim = 0; dim < points.cols(); ++dim) {
+            hash ^= std::hash<double>()(points(point, dim) + 0.0) + 0x9e3779b9 +
+                (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    // uniformly distributed random number in [0, 1) of a counter based generator,
+    // which hashes seed and counter with the finalizer of the splitmix64 generator
+    uint64_t mixBits(uint64_t value) {
+        value += 0x9e3779b97f4a7c15ull;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+
+    double uniformRandom(uint64_t const seed, uint64_t const counter) {
+        return (double)(mixBits(mixBits(seed) ^ counter) >> 11) / 9007199254740992.0;
+    }
+
+    // radius of the disks relative to the local point spacing, for which maximal
+    // Poisson disk sampling has about the point density of the hexagonal lattice
+    double const poissonDiskRadius = 0.75;
+
+    // select subset of points by maximal Poisson disk sampling: points are visited in the
+    // order of their priority and accepted, if no fixed or accepted point lies within
+    // their radius, using a grid of cells with the size of the smallest radius
+    Eigen::Array<bool, Eigen::Dynamic, 1> poissonDiskSample(
+        Eigen::Ref<Eigen::ArrayXXd const> const points, Eigen::Ref<Eigen::ArrayXd const> const radius,
+        Eigen::Ref<Eigen::ArrayXd const> const priority, Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints) {
+        Eigen::Array<bool, Eigen::Dynamic, 1> isAccepted =
+            Eigen::Array<bool, Eigen::Dynamic, 1>::Constant(points.rows(), false);
+        if (points.rows() == 0) {
+            return isAccepted;
+        }
+
+        // coordinates of points followed by fixed points stored contiguously for each point
+        unsigned const dimension = points.cols();
+        std::vector<double> coordinates((points.rows() + fixedPoints.rows()) * dimension);
+        for (int point = 0; point < points.rows() + fixedPoints.rows(); ++point)
+        for (unsigned dim = 0; dim < dimension; ++dim) {
+            coordinates[point * dimension + dim] = point < points.rows() ? points(point, dim) :
+                fixedPoints(point - points.rows(), dim);
+        }
+        auto const coordinate = [&](int const point, int const dim) {
+            return coordinates[point * dimension + dim];
+        };
+
+        Eigen::ArrayXd lower = points.colwise().minCoeff().transpose();
+        Eigen::ArrayXd upper = points.colwise().maxCoeff().transpose();
+        if (fixedPoints.rows() > 0) {
+            lower = lower.min(fixedPoints.colwise().minCoeff().transpose());
+            upper = upper.max(fixedPoints.colwise().maxCoeff().transpose());
+        }
+        double const cellSize = radius.minCoeff();
+
+        std::vector<int64_t> cellsPerDimension(dimension), cellStride(dimension);
+        for (unsigned dim = 0; dim < dimension; ++dim) {
+            cellsPerDimension[dim] = (int64_t)((upper(dim) - lower(dim)) / cellSize) + 1;
+            cellStride[dim] = dim == 0 ? 1 : cellStride[dim - 1] * cellsPerDimension[dim - 1];
+        }
+        auto const cellIndex = [&](int const point, int const dim) {
+            return std::min((int64_t)((coordinate(point, dim) - lower(dim)) / cellSize),
+                cellsPerDimension[dim] - 1);
+        };
+
+        // linked list of the points in each cell
+        std::vector<int> cellHead(cellStride[dimension - 1] * cellsPerDimension[dimension - 1], -1);
+        std::vector<int> next(points.rows() + fixedPoints.rows(), -1);
+        auto const insert = [&](int const point) {
+            int64_t cell = 0;
+            for (unsigned dim = 0; dim < dimension; ++dim) {
+                cell += cellIndex(point, dim) * cellStride[dim];
+            }
+            next[point] = cellHead[cell];
+            cellHead[cell] = point;
+        };
+        for (int point = 0; point < fixedPoints.rows(); ++point) {
+            insert(points.rows() + point);
+        }
+
+        std::vector<int> order(points.rows());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int const lhs, int const rhs) {
+            return priority(lhs) < priority(rhs) || (priority(lhs) == priority(rhs) && lhs < rhs);
+        });
+
+        std::vector<int64_t> center(dimension), begin(dimension), end(dimension), cell(dimension);
+        for (auto const point : order) {
+            // search cells intersecting disk of point in shells around its cell,
+            // such that close points rejecting it are usually found first
+            int64_t const reach = (int64_t)std::ceil(radius(point) / cellSize);
+            for (unsigned dim = 0; dim < dimension; ++dim) {
+                center[dim] = cellIndex(point, dim);
+            }
+
+            bool isFree = true;
+            for (int64_t shell = 0; (shell <= reach) && isFree; ++shell) {
+                for (unsigned dim = 0; dim < dimension; ++dim) {
+                    begin[dim] = std::max(center[dim] - shell, (int64_t)0);
+                    end[dim] = std::min(center[dim] + shell + 1, cellsPerDimension[dim]);
+                }
+
+                // traverse cells of shell along the first dimension, which all are part of it,
+                // if any other dimension is at the shell, or else only the outermost ones
+                cell = begin;
+                while (isFree) {
+                    bool isShell = false;
+                    int64_t offset = 0;
+                    for (unsigned dim = 1; dim < dimension; ++dim) {
+                        isShell |= std::abs(cell[dim] - center[dim]) == shell;
+                        offset += cell[dim] * cellStride[dim];
+                    }
+
+                    for (int64_t first = isShell ? begin[0] : center[0] - shell;
+                        (first < end[0]) && isFree; first += isShell ? 1 : std::max(2 * shell, (int64_t)1)) {
+                        if (first < 0) {
+                            continue;
+                        }
+
+                        for (int neighbour = cellHead[offset + first]; neighbour >= 0;
+                            neighbour = next[neighbour]) {
+                            double distance = 0.0;
+                            for (unsigned dim = 0; dim < dimension; ++dim) {
+                                double const delta = coordinate(point, dim) - coordinate(neighbour, dim);
+                                distance += delta * delta;
+                            }
+                            if (distance < radius(point) * radius(point)) {
+                                isFree = false;
+                                break;
+                            }
+                        }
+                    }
+
+                    unsigned dim = 1;
+                    for (; dim < dimension; ++dim) {
+                        if (++cell[dim] < end[dim]) {
+                            break;
+                        }
+                        cell[dim] = begin[dim];
+                    }
+                    if (dim >= dimension) {
+                        break;
+                    }
+                }
+            }
+
+            if (isFree) {
+                isAccepted(point) = true;
+                insert(point);
+            }
+        }
+
+        return isAccepted;
+    }
+
+    // append the points of the initial lattice with given spacing starting at the lower corner
+    // of the bounding box, which lie within the cell [lower, upper), with the random counter
+    // of each point given by its index in the lattice and the level of the lattice
+    void appendLatticePoints(double const spacing, unsigned const level,
+        Eigen::Ref<Eigen::ArrayXXd const> const boundingBox, double const* const lower,
+        double const* const upper, int const dim, std::vector<int64_t>& index,
+        std::vector<double>& points, std::vector<uint64_t>& counters) {
+        unsigned const dimension = boundingBox.cols();
+        if (dim < 0) {
+            uint64_t linearIndex = 0;
+            for (int other = dimension - 1; other >= 0; --other) {
+                int64_t const pointsPerDimension = (int64_t)std::ceil((boundingBox(1, other) -
+                    boundingBox(0, other)) / (spacing * (other == 0 ? 1.0 : sqrt(3.0) / 2.0))) + 1;
+                linearIndex = linearIndex * pointsPerDimension + index[other];
+            }
+            counters.push_back((linearIndex << 5) | level);
+
+            for (unsigned other = 0; other < dimension; ++other) {
+                points.push_back(boundingBox(0, other) + (double)index[other] * spacing *
+                    (other == 0 ? 1.0 : sqrt(3.0) / 2.0) +
+                    (other + 1 < dimension && index[other + 1] % 2 != 0 ? spacing / 2.0 : 0.0));
+            }
+            return;
+        }
+
+        // each second row of a dimension is shifted by half the spacing in the previous one
+        double const rowSpacing = spacing * (dim == 0 ? 1.0 : sqrt(3.0) / 2.0);
+        double const shift = dim + 1 < (int)dimension && index[dim + 1] % 2 != 0 ? spacing / 2.0 : 0.0;
+        int64_t const begin = std::max((int64_t)std::ceil(
+            (lower[dim] - boundingBox(0, dim) - shift) / rowSpacing), (int64_t)0);
+        int64_t const end = (int64_t)std::ceil((upper[dim] - boundingBox(0, dim) - shift) / rowSpacing);
+        for (index[dim] = begin; index[dim] < end; ++index[dim]) {
+            appendLatticePoints(spacing, level, boundingBox, lower, upper, dim - 1, index,
+                points, counters);
+        }
+    }
+
+    // candidates of the Poisson disk sampling placed at the local spacing: the cells of a
+    // tree over the bounding box are split, until they span only a few lattice spacings,
+    // where the lattice spacing of a cell is the largest power of two multiple of the
+    // initial point distance, which is at most half the local spacing at its center,
+    // and leaf cells are filled with the points of their lattice, such that the element
+    // size function is evaluated at the cell centers and candidates only and never on
+    // the complete lattice of the initial point distance
+    Eigen::ArrayXXd createPoissonDiskCandidates(distmesh::Functional const& distanceFunction,
+        double const initialPointDistance, distmesh::Functional const& elementSizeFunction,
+        Eigen::Ref<Eigen::ArrayXXd const> const boundingBox, distmesh::Options const& options,
+        std::vector<uint64_t>& counters) {
+        typedef Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorArray;
+        unsigned const dimension = boundingBox.cols();
+        double const threshold = distmesh::constants::geometryEvaluationThreshold * initialPointDistance;
+        double const slopeBound = distanceFunction.slopeBound();
+        unsigned const maxLevel = 31;
+        double const cellLatticeSpacings = 4.0;
+
+        std::vector<double> candidates;
+        std::vector<int64_t> index(dimension);
+        Eigen::ArrayXXd lower = boundingBox.row(0), upper = boundingBox.row(1);
+
+        // the local spacing is relative to the smallest element size found so far, which
+        // only decreases with finer cells, so coarse cells rather get too many candidates
+        double minimumSize = INFINITY;
+        while (lower.rows() > 0) {
+            Eigen::ArrayXXd const centers = 0.5 * (lower + upper);
+
+            // cells clearly outside of the region are skipped, if the slope bound is known
+            Eigen::Array<bool, Eigen::Dynamic, 1> isOutside =
+                Eigen::Array<bool, Eigen::Dynamic, 1>::Constant(centers.rows(), false);
+            if (!std::isinf(slopeBound)) {
+                isOutside = distanceFunction(centers, options.evaluation) -
+                    slopeBound * 0.5 * (upper - lower).square().rowwise().sum().sqrt() >= threshold;
+            }
+
+            Eigen::ArrayXd const size = elementSizeFunction(centers, options.evaluation);
+            for (int cell = 0; cell < centers.rows(); ++cell) {
+                if (!isOutside(cell)) {
+                    minimumSize = std::min(minimumSize, size(cell));
+                }
+            }
+
+            std::vector<double> nextLower, nextUpper;
+            for (int cell = 0; cell < centers.rows(); ++cell) {
+                if (isOutside(cell)) {
+                    continue;
+                }
+
+                double const localSpacing = initialPointDistance * size(cell) / minimumSize;
+                double spacing = initialPointDistance;
+                unsigned level = 0;
+                while ((level < maxLevel) && (4.0 * spacing <= localSpacing)) {
+                    spacing *= 2.0;
+                    ++level;
+                }
+
+                if ((upper.row(cell) - lower.row(cell)).maxCoeff() <= cellLatticeSpacings * spacing) {
+                    Eigen::ArrayXd const cellLower = lower.row(cell).transpose();
+                    Eigen::ArrayXd const cellUpper = upper.row(cell).transpose();
+                    appendLatticePoints(spacing, level, boundingBox, cellLower.data(),
+                        cellUpper.data(), dimension - 1, index, candidates, counters);
+                    continue;
+                }
+
+                // split cell in halves along all dimensions
+                for (int child = 0; child < (1 << dimension); ++child)
+                for (unsigned dim = 0; dim < dimension; ++dim) {
+                    nextLower.push_back((child >> dim) & 1 ? centers(cell, dim) : lower(cell, dim));
+                    nextUpper.push_back((child >> dim) & 1 ? upper(cell, dim) : centers(cell, dim));
+                }
+            }
+
+            lower = Eigen::Map<RowMajorArray>(nextLower.data(), nextLower.size() / dimension, dimension);
+            upper = Eigen::Map<RowMajorArray>(nextUpper.data(), nextUpper.size() / dimension, dimension);
+        }
+
+        return Eigen::Map<RowMajorArray>(candidates.data(), candidates.size() / dimension, dimension);
+    }
+}
+
 // create initial points distribution
 Eigen::ArrayXXd distmesh::utils::createInitialPoints(
     Functional const& distanceFunction, double const initialPointDistance,
     Functional const& elementSizeFunction, Eigen::Ref<Eigen::ArrayXXd const> const boundingBox,
-    Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints) {
+    Eigen::Ref<Eigen::ArrayXXd const> const fixedPoints, Options const& options) {
     // extract dimension of mesh
     unsigned const dimension = boundingBox.cols();
+    double const threshold = constants::geometryEvaluationThreshold * initialPointDistance;
+
+    if (options.initialization == Initialization::poissonDisk) {
+        // reject candidates outside of region defined by distance function
+        std::vector<uint64_t> counters;
+        Eigen::ArrayXXd points = createPoissonDiskCandidates(distanceFunction, initialPointDistance,
+            elementSizeFunction, boundingBox, options, counters);
+        Eigen::Array<bool, Eigen::Dynamic, 1> const isInside =
+            distanceFunction(points, options.evaluation) < threshold;
+        Eigen::Array<uint64_t, Eigen::Dynamic, Eigen::Dynamic> counter =
+            Eigen::Map<Eigen::Array<uint64_t, Eigen::Dynamic, 1>>(counters.data(), counters.size());
+        points = selectMaskedArrayElements<double>(points, isInside);
+        counter = selectMaskedArrayElements<uint64_t>(counter, isInside);
+
+        // place points at the local spacing given by the element size function, with
+        // the radius of the disks chosen to match the point density of the lattice
+        Eigen::ArrayXd const size = elementSizeFunction(points, options.evaluation);
+        Eigen::ArrayXd const radius = poissonDiskRadius * initialPointDistance * size /
+            (points.rows() > 0 ? size.minCoeff() : 1.0);
+        Eigen::ArrayXd random(points.rows());
+        for (int point = 0; point < points.rows(); ++point) {
+            random(point) = uniformRandom(options.seed, counter(point, 0));
+        }
+        points = selectMaskedArrayElements<double>(points,
+            poissonDiskSample(points, radius, random, fixedPoints));
+
+        // combine fixed and variable points to one array
+        Eigen::ArrayXXd finalPoints(points.rows() + fixedPoints.rows(), dimension);
+        finalPoints << fixedPoints, points;
+
+        return finalPoints;
+    }
 
-    // initially distribute points evenly in complete bounding box
-    Eigen::ArrayXi pointsPerDimension(dimension);
-    for (int dim = 0; dim < dimension; ++dim) {
-        pointsPerDimension(dim) = ceil((boundingBox(1, dim) - boundingBox(0, dim)) /
+    // initially distribute points evenly in complete bounding box, but only
+    // generate lattice points within the region defined by distance function
+    std::vector<int64_t> pointsPerDimension(dimension), stride(dimension);
+    for (unsigned dim = 0; dim < dimension; ++dim) {
+        pointsPerDimension[dim] = ceil((boundingBox(1, dim) - boundingBox(0, dim)) /
             (initialPointDistance * (dim == 0 ? 1.0 : sqrt(3.0) / 2.0)));
+        stride[dim] = dim == 0 ? 1 : stride[dim - 1] * pointsPerDimension[dim - 1];
     }
 
-    Eigen::ArrayXXd points(pointsPerDimension.prod(), dimension);
-    for (int point = 0; point < points.rows(); ++point)
-    for (int dim = 0; dim < dimension; ++dim) {
-        int const pointIndex = (point / std::max(pointsPerDimension.topRows(dim).prod(), 1)) %
-            pointsPerDimension(dim);
+    // coordinates of lattice point with given linear index, each second row of a
+    // dimension is shifted by half the point distance in the previous dimension
+    auto const latticePoint = [&](int64_t const index, Eigen::ArrayXXd& points, int const row) {
+        for (unsigned dim = 0; dim < dimension; ++dim) {
+            int64_t const pointIndex = (index / stride[dim]) % pointsPerDimension[dim];
+
+            points(row, dim) = boundingBox(0, dim) + (double)pointIndex * initialPointDistance *
+                (dim == 0 ? 1.0 : sqrt(3.0) / 2.0);
+
+            if (dim > 0) {
+                points(row, dim - 1) += pointIndex % 2 != 0 ? initialPointDistance / 2.0 : 0.0;
+            }
+        }
+    };
+
+    // traverse lattice hierarchically, with the slope bound of distance function
+    // limiting its values within a block by the value at the block center, blocks
+    // clearly outside of region are skipped and blocks clearly inside accepted
+    // without further evaluation, for an unknown slope bound all points are evaluated
+    double const slopeBound = distanceFunction.slopeBound();
+    unsigned const leafSize = 64;
+
+    std::vector<int64_t> insideIndices, candidateIndices;
+    std::vector<LatticeBlock> blocks(1, LatticeBlock{
+        std::vector<int64_t>(dimension, 0), pointsPerDimension });
+    if (blocks[0].pointCount() == 0) {
+        blocks.clear();
+    }
+
+    while (!blocks.empty()) {
+        if (std::isinf(slopeBound)) {
+            for (auto const& block : blocks) {
+                block.appendIndices(stride, candidateIndices);
+            }
+            break;
+        }
+
+        // spatial extent of each block including the shift of every second row
+        Eigen::ArrayXXd lower(blocks.size(), dimension), upper(blocks.size(), dimension);
+        for (int block = 0; block < static_cast<int>(blocks.size()); ++block)
+        for (unsigned dim = 0; dim < dimension; ++dim) {
+            double const spacing = initialPointDistance * (dim == 0 ? 1.0 : sqrt(3.0) / 2.0);
+            lower(block, dim) = boundingBox(0, dim) + (double)blocks[block].begin[dim] * spacing;
+            upper(block, dim) = boundingBox(0, dim) + (double)(blocks[block].end[dim] - 1) * spacing +
+                (dim + 1 < dimension ? initialPointDistance / 2.0 : 0.0);
+        }
+        Eigen::ArrayXd const distance = distanceFunction(0.5 * (lower + upper), options.evaluation);
+        Eigen::ArrayXd const radius = 0.5 * (upper - lower).square().rowwise().sum().sqrt();
+
+        std::vector<LatticeBlock> nextBlocks;
+        for (int block = 0; block < static_cast<int>(blocks.size()); ++block) {
+            if (distance(block) - slopeBound * radius(block) >= threshold) {
+                continue;
+            }
+            else if (distance(block) + slopeBound * radius(block) < threshold) {
+                blocks[block].appendIndices(stride, insideIndices);
+            }
+            else if (blocks[block].pointCount() <= leafSize) {
+                blocks[block].appendIndices(stride, candidateIndices);
+            }
+            else {
+                // split block in halves along its largest spatial extent
+                int splitDim = -1;
+                for (unsigned dim = 0; dim < dimension; ++dim) {
+                    if ((blocks[block].end[dim] - blocks[block].begin[dim] >= 2) &&
+                        (splitDim < 0 || upper(block, dim) - lower(block, dim) >
+                            upper(block, splitDim) - lower(block, splitDim))) {
+                        splitDim = dim;
+                    }
+                }
 
-        points(point, dim) = boundingBox(0, dim) + (double)pointIndex * initialPointDistance *
-            (dim == 0 ? 1.0 : sqrt(3.0) / 2.0);
+                LatticeBlock lowerHalf = blocks[block], upperHalf = blocks[block];
+                lowerHalf.end[splitDim] = upperHalf.begin[splitDim] =
+                    (blocks[block].begin[splitDim] + blocks[block].end[splitDim]) / 2;
+                nextBlocks.push_back(lowerHalf);
+                nextBlocks.push_back(upperHalf);
+            }
+        }
+        blocks.swap(nextBlocks);
+    }
 
-        if (dim > 0) {
-            points(point, dim - 1) += pointIndex % 2 != 0 ? initialPointDistance / 2.0 : 0.0;
+    // reject candidate points outside of region defined by distance function
+    Eigen::ArrayXXd candidates(candidateIndices.size(), dimension);
+    for (int point = 0; point < candidates.rows(); ++point) {
+        latticePoint(candidateIndices[point], candidates, point);
+    }
+    Eigen::ArrayXd const candidateDistance = distanceFunction(candidates, options.evaluation);
+    for (int point = 0; point < candidates.rows(); ++point) {
+        if (candidateDistance(point) < threshold) {
+            insideIndices.push_back(candidateIndices[point]);
         }
     }
 
-    // reject points outside of region defined by distance function
-    points = selectMaskedArrayElements<double>(points,
-        distanceFunction(points) < constants::geometryEvaluationThreshold * initialPointDistance);
+    // create points in lattice order
+    std::sort(insideIndices.begin(), insideIndices.end());
+    Eigen::ArrayXXd points(insideIndices.size(), dimension);
+    #pragma omp parallel for
+    for (int point = 0; point < points.rows(); ++point) {
+        latticePoint(insideIndices[point], points, point);
+    }
+
+    // lattice index of each point identifying its random number
+    Eigen::Array<int64_t, Eigen::Dynamic, Eigen::Dynamic> latticeIndices =
+        Eigen::Map<Eigen::Array<int64_t, Eigen::Dynamic, 1>>(insideIndices.data(), insideIndices.size());
+
+    // clear points duplicating fixed points by looking up their exact coordinates
+    std::unordered_multimap<std::size_t, int> fixedPointTable;
+    for (int point = 0; point < fixedPoints.rows(); ++point) {
+        fixedPointTable.emplace(hashPoint(fixedPoints, point), point);
+    }
 
-    // clear duplicate points
     Eigen::Array<bool, Eigen::Dynamic, 1> isUniquePoint =
         Eigen::Array<bool, Eigen::Dynamic, 1>::Constant(points.rows(), true);
-    for (int i = 0; i < fixedPoints.rows(); ++i)
-    for (int j = 0; j < points.rows(); ++j) {
-        isUniquePoint(j) &= !(fixedPoints.row(i) == points.row(j)).all();
+    if (!fixedPointTable.empty()) {
+        for (int point = 0; point < points.rows(); ++point) {
+            auto const range = fixedPointTable.equal_range(hashPoint(points, point));
+            for (auto entry = range.first; entry != range.second; ++entry) {
+                isUniquePoint(point) &= !(fixedPoints.row(entry->second) == points.row(point)).all();
+            }
+        }
     }
     points = selectMaskedArrayElements<double>(points, isUniquePoint);
+    latticeIndices = selectMaskedArrayElements<int64_t>(latticeIndices, isUniquePoint);
 
     // calculate probability to keep points
-    Eigen::ArrayXd probability = 1.0 / elementSizeFunction(points).pow(dimension);
+    Eigen::ArrayXd probability = 1.0 / elementSizeFunction(points, options.evaluation).pow(dimension);
     probability /= probability.maxCoeff();
 
+    // the random number of each point only depends on seed and lattice index
+    // and not on the order of evaluation
+    Eigen::ArrayXd random(points.rows());
+    #pragma omp parallel for
+    for (int point = 0; point < points.rows(); ++point) {
+        random(point) = uniformRandom(options.seed, latticeIndices(point, 0));
+    }
+
     // reject points with wrong probability
-    points = selectMaskedArrayElements<double>(points,
-        0.5 * (1.0 + Eigen::ArrayXd::Random(points.rows())) < probability);
+    points = selectMaskedArrayElements<double>(points, random < probability);
 
     // combine fixed and variable points to one array
     Eigen::ArrayXXd finalPoints(points.rows() + fixedPoints.rows(), dimension);
@@ -113,32 +571,120 @@ Eigen::ArrayXXi distmesh::utils::nOverK(unsigned const n, unsigned const k) {
     return combinations;
 }
 
+// invert index table to adjacency in compressed sparse row format
+distmesh::utils::Adjacency distmesh::utils::invertIndexTable(
+    Eigen::Ref<Eigen::ArrayXXi const> const table, unsigned const entityCount) {
+    // count rows adjacent to each entity and accumulate to offsets
+    Adjacency adjacency;
+    adjacency.offsets = Eigen::ArrayXi::Zero(entityCount + 1);
+    for (int row = 0; row < table.rows(); ++row)
+    for (int col = 0; col < table.cols(); ++col) {
+        if (table(row, col) >= 0) {
+            adjacency.offsets(table(row, col) + 1)++;
+        }
+    }
+    std::partial_sum(adjacency.offsets.data(), adjacency.offsets.data() + adjacency.offsets.rows(),
+        adjacency.offsets.data());
+
+    // fill in row indices, iterating rows in ascending order keeps them sorted
+    adjacency.indices.resize(adjacency.offsets(entityCount));
+    Eigen::ArrayXi insertPosition = adjacency.offsets.head(entityCount);
+    for (int row = 0; row < table.rows(); ++row)
+    for (int col = 0; col < table.cols(); ++col) {
+        if (table(row, col) >= 0) {
+            adjacency.indices(insertPosition(table(row, col))++) = row;
+        }
+    }
+
+    return adjacency;
+}
+
+// create adjacency of each node to all elements containing it
+distmesh::utils::Adjacency distmesh::utils::nodeElementAdjacency(
+    Eigen::Ref<Eigen::ArrayXXi const> const triangulation, unsigned const nodeCount) {
+    return invertIndexTable(triangulation, nodeCount);
+}
+
+// create adjacency of each edge to all elements containing it
+distmesh::utils::Adjacency distmesh::utils::edgeElementAdjacency(
+    Eigen::Ref<Eigen::ArrayXXi const> const edgeIndices, unsigned const edgeCount) {
+    return invertIndexTable(edgeIndices, edgeCount);
+}
+
+// find neighbouring element across each element edge
+Eigen::ArrayXXi distmesh::utils::elementNeighbours(
+    Eigen::Ref<Eigen::ArrayXXi const> const edgeIndices, Adjacency const& edgeElements) {
+    Eigen::ArrayXXi neighbours = Eigen::ArrayXXi::Constant(edgeIndices.rows(),
+        edgeIndices.cols(), -1);
+    for (int element = 0; element < edgeIndices.rows(); ++element)
+    for (int edge = 0; edge < edgeIndices.cols(); ++edge) {
+        auto const edgeIndex = edgeIndices(element, edge);
+        if ((edgeIndex >= 0) && (edgeElements.count(edgeIndex) == 2)) {
+            neighbours(element, edge) = edgeElements(edgeIndex, 0) == element ?
+                edgeElements(edgeIndex, 1) : edgeElements(edgeIndex, 0);
+        }
+    }
+
+    return neighbours;
+}
+
+// colour edges greedily, such that no two edges of the same colour share a node
+distmesh::utils::Adjacency distmesh::utils::colourEdges(
+    Eigen::Ref<Eigen::ArrayXXi const> const edges, unsigned const nodeCount) {
+    auto const nodeEdges = invertIndexTable(edges, nodeCount);
+
+    // assign smallest colour not used by any already coloured edge sharing a node,
+    // colours used by neighbours are marked with the index of the current edge
+    Eigen::ArrayXXi colours = Eigen::ArrayXXi::Constant(edges.rows(), 1, -1);
+    std::vector<int> usedColours;
+    int colourCount = 0;
+    for (int edge = 0; edge < edges.rows(); ++edge) {
+        for (int node = 0; node < edges.cols(); ++node)
+        for (int n = 0; n < nodeEdges.count(edges(edge, node)); ++n) {
+            auto const colour = colours(nodeEdges(edges(edge, node), n), 0);
+            if (colour >= 0) {
+                usedColours[colour] = edge;
+            }
+        }
+
+        int colour = 0;
+        while ((colour < colourCount) && (usedColours[colour] == edge)) {
+            colour++;
+        }
+        if (colour == colourCount) {
+            usedColours.push_back(-1);
+            colourCount++;
+        }
+        colours(edge, 0) = colour;
+    }
+
+    return invertIndexTable(colours, colourCount);
+}
+
 Eigen::ArrayXXi distmesh::utils::findUniqueEdges(Eigen::Ref<Eigen::ArrayXXi const> const triangulation) {
     // find all unique combinations
     auto const combinations = nOverK(triangulation.cols(), 2);
 
-    // find unique edges for all combinations
+    // pack all edges of all combinations into 64 bit keys,
     // guarantee direction of edges with lower node index to higher index
-    std::set<std::array<int, 2>> uniqueEdges;
-    std::array<int, 2> edge = {{0, 0}};
+    std::vector<uint64_t> edgeKeys(combinations.rows() * triangulation.rows());
     for (int combination = 0; combination < combinations.rows(); ++combination)
     for (int triangle = 0; triangle < triangulation.rows(); ++triangle) {
-        edge[0] = triangulation(triangle, combinations(combination, 0));
-        edge[1] = triangulation(triangle, combinations(combination, 1));
-
-        edge = edge[1] < edge[0] ? std::array<int, 2>{edge[1], edge[0]} : edge;
-
-        uniqueEdges.insert(edge);
+        edgeKeys[combination * triangulation.rows() + triangle] = packEdge(
+            triangulation(triangle, combinations(combination, 0)),
+            triangulation(triangle, combinations(combination, 1)));
     }
 
-    // copy set to eigen array
-    Eigen::ArrayXXi edgeIndices(uniqueEdges.size(), 2);
-    int index = 0;
-    for (auto const& edge : uniqueEdges) {
-        edgeIndices(index, 0) = edge[0];
-        edgeIndices(index, 1) = edge[1];
+    // sorting the keys orders the edges lexicographically, so duplicates
+    // are adjacent and can be removed in a single pass
+    std::sort(edgeKeys.begin(), edgeKeys.end());
+    edgeKeys.erase(std::unique(edgeKeys.begin(), edgeKeys.end()), edgeKeys.end());
 
-        index++;
+    // copy keys to eigen array
+    Eigen::ArrayXXi edgeIndices(edgeKeys.size(), 2);
+    for (int edge = 0; edge < edgeIndices.rows(); ++edge) {
+        edgeIndices(edge, 0) = (int)(edgeKeys[edge] >> 32);
+        edgeIndices(edge, 1) = (int)(edgeKeys[edge] & 0xffffffff);
     }
 
     return edgeIndices;
@@ -147,26 +693,40 @@ Eigen::ArrayXXi distmesh::utils::findUniqueEdges(Eigen::Ref<Eigen::ArrayXXi cons
 Eigen::ArrayXXi distmesh::utils::getTriangulationEdgeIndices(
     Eigen::Ref<Eigen::ArrayXXi const> const triangulation,
     Eigen::Ref<Eigen::ArrayXXi const> const edges) {
+    Eigen::ArrayXXi edgeIndices = Eigen::ArrayXXi::Constant(triangulation.rows(),
+        triangulation.cols(), -1);
+    if ((triangulation.rows() == 0) || (edges.rows() == 0)) {
+        return edgeIndices;
+    }
+
+    // create adjacency of each node to all edges containing it,
+    // so each edge can be found by scanning the few edges of a single node
+    int const nodeCount = std::max(edges.maxCoeff(), triangulation.maxCoeff()) + 1;
+    auto const nodeEdges = invertIndexTable(edges, nodeCount);
+
     // find indices for each edge of triangulation in edge index array
-    Eigen::ArrayXXi edgeIndices(triangulation.rows(), triangulation.cols());
     for (int element = 0; element < triangulation.rows(); ++element)
     for (int node = 0; node < triangulation.cols(); ++node) {
         // create edge with direction from node with lower index
         // to node with higher index
-        auto const edge = (Eigen::ArrayXi(2) << triangulation(element, node), triangulation(element, (node + 1) % triangulation.cols())).finished();
+        int const node1 = triangulation(element, node);
+        int const node2 = triangulation(element, (node + 1) % triangulation.cols());
+        int const lowerNode = std::min(node1, node2);
+        int const higherNode = std::max(node1, node2);
 
         // check if edge is in edges list, and get index
-        int edgeIndex = 0;
-        if (((edges.rowwise() - edge.transpose()).square().rowwise().sum().minCoeff(&edgeIndex) == 0) ||
-            ((edges.rowwise() - edge.transpose().reverse()).square().rowwise().sum().minCoeff(&edgeIndex) == 0)) {
-            edgeIndices(element, node) = edgeIndex;
+        for (int i = 0; i < nodeEdges.count(lowerNode); ++i) {
+            auto const edge = nodeEdges(lowerNode, i);
+            if (std::max(edges(edge, 0), edges(edge, 1)) == higherNode) {
+                edgeIndices(element, node) = edge;
+                break;
+            }
         }
     }
 
     return edgeIndices;
 }
 
-
 // determine boundary edges of given triangulation
 Eigen::ArrayXi distmesh::utils::boundEdges(
     Eigen::Ref<Eigen::ArrayXXi const> const triangulation,
@@ -190,23 +750,26 @@ Eigen::ArrayXi distmesh::utils::boundEdges(
         edgeIndices = _edgeIndices;
     }
 
-    // find edges, which only appear once in triangulation
-    std::set<int> uniqueEdges;
-    std::vector<int> boundaryEdges;
+    // count appearance of each edge in triangulation,
+    // element edges missing in the edge list are skipped
+    std::vector<int> edgeCount(edges.rows(), 0);
     for (int triangle = 0; triangle < triangulation.rows(); ++triangle)
     for (int edge = 0; edge < triangulation.cols(); ++edge) {
-        auto const edgeIndex = edgeIndices(triangle, edge);
-
-        // insert edge in set to get info about multiple appearance
-        if (!std::get<1>(uniqueEdges.insert(edgeIndex))) {
-            // find edge in vector and delete it
-            auto const it = std::find(boundaryEdges.begin(), boundaryEdges.end(), edgeIndex);
-            if (it != boundaryEdges.end()) {
-                boundaryEdges.erase(it);
-            }
+        if (edgeIndices(triangle, edge) >= edges.rows()) {
+            throw std::invalid_argument("distmesh::utils::boundEdges: edge index out of range");
         }
-        else {
-            boundaryEdges.push_back(edgeIndex);
+        if (edgeIndices(triangle, edge) >= 0) {
+            edgeCount[edgeIndices(triangle, edge)]++;
+        }
+    }
+
+    // collect edges, which only appear once in triangulation,
+    // in the order of their appearance
+    std::vector<int> boundaryEdges;
+    for (int triangle = 0; triangle < triangulation.rows(); ++triangle)
+    for (int edge = 0; edge < triangulation.cols(); ++edge) {
+        if ((edgeIndices(triangle, edge) >= 0) && (edgeCount[edgeIndices(triangle, edge)] == 1)) {
+            boundaryEdges.push_back(edgeIndices(triangle, edge));
         }
     }
 
@@ -215,7 +778,7 @@ Eigen::ArrayXi distmesh::utils::boundEdges(
     for (int edge = 0; edge < boundary.rows(); ++edge) {
         boundary(edge) = boundaryEdges[edge];
     }
-    
+
     return boundary;
 }
 
@@ -230,11 +793,11 @@ Eigen::ArrayXXi distmesh::utils::fixBoundaryEdgeOrientation(
     // for the 2-D case fix orientation of boundary edges
     if (nodes.cols() == 2) {
         auto const boundary = utils::boundEdges(triangulation, edges, edgeIndices);
+        auto const edgeElements = utils::edgeElementAdjacency(edgeIndices, edges.rows());
 
         for (int edge = 0; edge < boundary.rows(); ++edge) {
-            // find get index of element containing boundary edge
-            int elementIndex = 0, edgeIndex = 0;
-            (edgeIndices - boundary(edge)).square().minCoeff(&elementIndex, &edgeIndex);
+            // get index of the only element containing boundary edge
+            int const elementIndex = edgeElements(boundary(edge), 0);
 
             // get index of node not used in edge, but in the triangle
             int nodeIndex = 0;
@@ -262,25 +825,80 @@ Eigen::ArrayXXi distmesh::utils::fixBoundaryEdgeOrientation(
 void distmesh::utils::projectPointsToBoundary(
     Functional const& distanceFunction, double const initialPointDistance,
     Eigen::Ref<Eigen::ArrayXXd> points) {
-    Eigen::ArrayXd distance = distanceFunction(points);
+    DistmeshWorkspace workspace;
+    projectPointsToBoundary(distanceFunction, initialPointDistance, points, workspace, Options());
+}
 
-    // check for points outside of boundary
-    Eigen::Array<bool, Eigen::Dynamic, 1> outside = distance > 0.0;
-    if (outside.any()) {
-        // calculate gradient
-        Eigen::ArrayXXd gradient(points.rows(), points.cols());
-        Eigen::ArrayXXd deltaX = Eigen::ArrayXXd::Zero(points.rows(), points.cols());
+// project points outside of domain back to boundary using the buffers of the workspace
+void distmesh::utils::projectPointsToBoundary(
+    Functional const& distanceFunction, double const initialPointDistance,
+    Eigen::Ref<Eigen::ArrayXXd> points, DistmeshWorkspace& workspace, Options const& options) {
+    workspace.candidateIndices.resize(points.rows());
+    workspace.candidatePoints.resize(points.rows(), points.cols());
+    workspace.candidateDistance.resize(points.rows());
+    workspace.gradient.resize(points.rows(), points.cols());
+
+    // points further inside than the band width times the slope bound of the distance
+    // function cannot leave the domain, as long as no point moved further than the band
+    // width since the creation of the band, for an unknown slope bound no band is used
+    double const slopeBound = options.boundaryBandWidth > 0.0 ? distanceFunction.slopeBound() : INFINITY;
+    double const bandWidth = std::isinf(slopeBound) ? 0.0 :
+        options.boundaryBandWidth * initialPointDistance;
+    double const bandDistance = slopeBound * bandWidth;
+    bool const bandValid = (bandWidth > 0.0) &&
+        (workspace.bandReference.rows() == points.rows()) &&
+        (workspace.bandReference.cols() == points.cols()) &&
+        ((points - workspace.bandReference).square().rowwise().sum().maxCoeff() <
+            bandWidth * bandWidth);
+
+    // candidates for projection
+    int candidateCount = 0;
+    if (bandValid) {
+        for (int n = 0; n < workspace.bandIndices.rows(); ++n) {
+            workspace.candidateIndices(candidateCount++) = workspace.bandIndices(n);
+        }
+    }
+    else {
+        workspace.distance.resize(points.rows());
+        distanceFunction.evaluate(points, workspace.distance, options.evaluation);
 
-        for (int dim = 0; dim < points.cols(); ++dim) {
-            deltaX.col(dim).fill(constants::deltaX * initialPointDistance);
-            gradient.col(dim) = (distanceFunction(points + deltaX) - distance) /
-                (constants::deltaX * initialPointDistance);
-            deltaX.col(dim).fill(0.0);
+        for (int point = 0; point < points.rows(); ++point) {
+            if (workspace.distance(point) > 0.0) {
+                workspace.candidateIndices(candidateCount++) = point;
+            }
         }
 
-        // project points back to boundary
-        points -= outside.replicate(1, points.cols()).select(
-            gradient.colwise() * distance / gradient.square().rowwise().sum(), 0.0);
+        // create new band of points near the boundary
+        if (bandWidth > 0.0) {
+            workspace.bandIndices.resize((workspace.distance >= -bandDistance).count());
+            for (int point = 0, n = 0; point < points.rows(); ++point) {
+                if (workspace.distance(point) >= -bandDistance) {
+                    workspace.bandIndices(n++) = point;
+                }
+            }
+            workspace.bandReference = points;
+        }
+    }
+    if (candidateCount == 0) {
+        return;
+    }
+
+    // evaluate distance and its gradient for the compact set of candidates in a single pass,
+    // only parts of the distance function without analytic gradient use finite differences
+    for (int n = 0; n < candidateCount; ++n) {
+        workspace.candidatePoints.row(n) = points.row(workspace.candidateIndices(n));
+    }
+    distanceFunction.evaluate(workspace.candidatePoints.topRows(candidateCount),
+        workspace.candidateDistance.head(candidateCount),
+        workspace.gradient.topRows(candidateCount),
+        options.deltaX * initialPointDistance, options.evaluation);
+
+    // project points outside of boundary back to boundary
+    for (int n = 0; n < candidateCount; ++n) {
+        if (workspace.candidateDistance(n) > 0.0) {
+            points.row(workspace.candidateIndices(n)) -= workspace.gradient.row(n) *
+                workspace.candidateDistance(n) / workspace.gradient.row(n).square().sum();
+        }
     }
 }
 
@@ -288,13 +906,5 @@ void distmesh::utils::projectPointsToBoundary(
 Eigen::ArrayXd distmesh::utils::pointsInsidePoly(
     Eigen::Ref<Eigen::ArrayXXd const> const points,
     Eigen::Ref<Eigen::ArrayXXd const> const polygon) {
-    Eigen::ArrayXd inside = Eigen::ArrayXd::Zero(points.rows());
-
-    for (int i = 0, j = polygon.rows() - 1; i < polygon.rows(); j = i++) {
-        inside = (((points.col(1) < polygon(i, 1)) != (points.col(1) < polygon(j, 1))) &&
-            (points.col(0) < (polygon(j, 0) - polygon(i, 0)) * (points.col(1) - polygon(i, 1)) /
-            (polygon(j, 1) - polygon(i, 1)) + polygon(i, 0))).select(1.0 - inside, inside);
-    }
-
-    return inside;
+    return geometry::InsideGrid(std::vector<Eigen::ArrayXXd>(1, polygon)).pointsInside(points);
 }
@@ -0,0 +1,40 @@
+// --------------------------------------------------------------------
+// This file is part of libDistMesh.
+//
+// libDistMesh is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// libDistMesh is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with libDistMesh. If not, see <http://www.gnu.org/licenses/>.
+//
+// Copyright (C) 2015 Patrik Gebhardt
+// Contact: patrik.gebhardt@rub.de
+// --------------------------------------------------------------------
+
+#include "distmesh/distmesh.h"
+
+// adjust size of all buffers
+void distmesh::DistmeshWorkspace::resize(unsigned const pointCount,
+    unsigned const edgeCount, unsigned const dimension) {
+    this->edgeVector.resize(edgeCount, dimension);
+    this->edgeLength.resize(edgeCount);
+    this->edgeMidpoints.resize(edgeCount, dimension);
+    this->desiredElementSize.resize(edgeCount);
+    this->desiredEdgeLength.resize(edgeCount);
+    this->forceVector.resize(edgeCount, dimension);
+
+    this->previousPoints.resize(pointCount, dimension);
+    this->distance.resize(pointCount);
+    this->nodeForce.resize(pointCount, dimension);
+    this->candidateIndices.resize(pointCount);
+    this->candidatePoints.resize(pointCount, dimension);
+    this->candidateDistance.resize(pointCount);
+    this->gradient.resize(pointCount, dimension);
+}